@@ -0,0 +1,36 @@
+/***************
+ * THECURLE    *
+ *     BOUNCER *
+ ***************/
+
+#include <string>
+
+#pragma once
+
+// A string as a JSON string literal, quoted and escaped; paths on Windows are full of backslashes, and scene names and
+// file names can hold anything.
+inline std::string jsonString(const std::string& s) {
+    static const char hex[] = "0123456789abcdef";
+    std::string out = "\"";
+    for (char c : s) {
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\b': out += "\\b"; break;
+            case '\f': out += "\\f"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                // Every other control character has to be written as its code.
+                if ((unsigned char) c < 0x20) {
+                    out += "\\u00";
+                    out += hex[(unsigned char) c >> 4];
+                    out += hex[(unsigned char) c & 0xF];
+                } else {
+                    out += c;
+                }
+        }
+    }
+    return out + "\"";
+}
@@ -18,6 +18,317 @@
 
 bool safeCompare(double a, double b);
 
+/**
+ * Represents a 4x4 matrix, stored inline in row-major order.
+ *
+ * This is the type used for every transform in the renderer. It is trivially copyable and never touches the heap,
+ * so it can be passed around by value and applied to rays without indirection.
+ * See Matrix below for arbitrary sizes.
+ */
+struct Mat4 {
+    Scalar data[16];
+
+    // Zero matrix.
+    constexpr Mat4() : data{} {}
+
+    // Value constructor, in row-major order.
+    constexpr Mat4(Scalar a00, Scalar a01, Scalar a02, Scalar a03,
+                   Scalar a10, Scalar a11, Scalar a12, Scalar a13,
+                   Scalar a20, Scalar a21, Scalar a22, Scalar a23,
+                   Scalar a30, Scalar a31, Scalar a32, Scalar a33)
+            : data{ a00, a01, a02, a03,
+                    a10, a11, a12, a13,
+                    a20, a21, a22, a23,
+                    a30, a31, a32, a33 } {}
+
+    // Retrieve the Identity matrix. Transforms and multiplications to this are effectively null.
+    static constexpr Mat4 identity() {
+        return {
+            1, 0, 0, 0,
+            0, 1, 0, 0,
+            0, 0, 1, 0,
+            0, 0, 0, 1
+        };
+    }
+
+    // Fetch a matrix that will translate points around by the given coordinates.
+    static constexpr Mat4 translation(Scalar x, Scalar y, Scalar z) {
+        return {
+            1, 0, 0, x,
+            0, 1, 0, y,
+            0, 0, 1, z,
+            0, 0, 0, 1
+        };
+    }
+
+    // Fetch a matrix that will scale points by the given factors.
+    static constexpr Mat4 scaling(Scalar x, Scalar y, Scalar z) {
+        return {
+            x, 0, 0, 0,
+            0, y, 0, 0,
+            0, 0, z, 0,
+            0, 0, 0, 1
+        };
+    }
+
+    // Fetch a matrix that will rotate points clockwise around the X axis by the given factor (interpreted in radians)
+    static Mat4 rotation_x(Scalar factor) {
+        Scalar c = std::cos(factor), s = std::sin(factor);
+        return {
+            1, 0, 0, 0,
+            0, c, -s, 0,
+            0, s, c, 0,
+            0, 0, 0, 1
+        };
+    }
+
+    // Fetch a matrix that will rotate points clockwise around the Y axis by the given factor (interpreted in radians)
+    static Mat4 rotation_y(Scalar factor) {
+        Scalar c = std::cos(factor), s = std::sin(factor);
+        return {
+            c, 0, s, 0,
+            0, 1, 0, 0,
+            -s, 0, c, 0,
+            0, 0, 0, 1
+        };
+    }
+
+    // Fetch a matrix that will rotate points clockwise around the Z axis by the given factor (interpreted in radians)
+    static Mat4 rotation_z(Scalar factor) {
+        Scalar c = std::cos(factor), s = std::sin(factor);
+        return {
+            c, -s, 0, 0,
+            s, c, 0, 0,
+            0, 0, 1, 0,
+            0, 0, 0, 1
+        };
+    }
+
+    // Fetch a matrix that will skew / shear points in the given magnitudes.
+    static constexpr Mat4 shearing(Scalar xy, Scalar xz, Scalar yx, Scalar yz, Scalar zx, Scalar zy) {
+        return {
+            1, xy, xz, 0,
+            yx, 1, yz, 0,
+            zx, zy, 1, 0,
+            0, 0, 0, 1
+        };
+    }
+
+    static Mat4 rotation(const Quat& q) {
+        Scalar x = q.x, y = q.y, z = q.z, s = q.w;
+        return {
+            1 - 2*y*y - 2*z*z, 2*x*y - 2*s*z, 2*x*z + 2*s*y, 0,
+            2*x*y + 2*s*z, 1 - 2*x*x - 2*z*z, 2*y*z - 2*s*x, 0,
+            2*x*z - 2*s*y, 2*y*z + 2*s*x, 1 - 2*x*x - 2*y*y, 0,
+            0, 0, 0, 1
+        };
+    }
+
+    // Transpose the matrix; columns become rows, and rows become columns.
+    static constexpr Mat4 transpose(const Mat4& in) {
+        const Scalar* d = in.data;
+        return {
+            d[0], d[4], d[8], d[12],
+            d[1], d[5], d[9], d[13],
+            d[2], d[6], d[10], d[14],
+            d[3], d[7], d[11], d[15]
+        };
+    }
+
+    // Calculate the determinant, expanded over the 2x2 minors of the top and bottom halves.
+    static constexpr Scalar determinant(const Mat4& in) {
+        const Scalar* m = in.data;
+        Scalar s0 = m[0] * m[5] - m[4] * m[1];
+        Scalar s1 = m[0] * m[6] - m[4] * m[2];
+        Scalar s2 = m[0] * m[7] - m[4] * m[3];
+        Scalar s3 = m[1] * m[6] - m[5] * m[2];
+        Scalar s4 = m[1] * m[7] - m[5] * m[3];
+        Scalar s5 = m[2] * m[7] - m[6] * m[3];
+
+        Scalar c5 = m[10] * m[15] - m[14] * m[11];
+        Scalar c4 = m[9] * m[15] - m[13] * m[11];
+        Scalar c3 = m[9] * m[14] - m[13] * m[10];
+        Scalar c2 = m[8] * m[15] - m[12] * m[11];
+        Scalar c1 = m[8] * m[14] - m[12] * m[10];
+        Scalar c0 = m[8] * m[13] - m[12] * m[9];
+
+        return s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+    }
+
+    // Whether the matrix only rotates, scales, shears and translates; ie. the bottom row is (0, 0, 0, 1).
+    // Every transform built from the factories above is affine.
+    [[nodiscard]] constexpr bool isAffine() const {
+        return data[12] == 0 && data[13] == 0 && data[14] == 0 && data[15] == 1;
+    }
+
+    // Calculate the inverse of the matrix.
+    // Affine matrices take the closed form below; anything else falls back to an LU decomposition.
+    // Returns the identity if the matrix is not invertible.
+    static Mat4 inverse(const Mat4& in) {
+        return in.isAffine() ? affineInverse(in) : generalInverse(in);
+    }
+
+    // The inverse of an affine matrix is the inverse of the upper-left 3x3, with the translation pulled back through it.
+    // The 3x3 inverse is its' adjugate divided by the determinant, written out in full.
+    static Mat4 affineInverse(const Mat4& in) {
+        const Scalar* m = in.data;
+
+        Scalar c00 = m[5] * m[10] - m[6] * m[9];
+        Scalar c01 = m[2] * m[9] - m[1] * m[10];
+        Scalar c02 = m[1] * m[6] - m[2] * m[5];
+        Scalar c10 = m[6] * m[8] - m[4] * m[10];
+        Scalar c11 = m[0] * m[10] - m[2] * m[8];
+        Scalar c12 = m[2] * m[4] - m[0] * m[6];
+        Scalar c20 = m[4] * m[9] - m[5] * m[8];
+        Scalar c21 = m[1] * m[8] - m[0] * m[9];
+        Scalar c22 = m[0] * m[5] - m[1] * m[4];
+
+        Scalar det = m[0] * c00 + m[1] * c10 + m[2] * c20;
+        if (det == 0) return identity();
+
+        Scalar inv = 1 / det;
+        c00 *= inv; c01 *= inv; c02 *= inv;
+        c10 *= inv; c11 *= inv; c12 *= inv;
+        c20 *= inv; c21 *= inv; c22 *= inv;
+
+        return {
+            c00, c01, c02, -(c00 * m[3] + c01 * m[7] + c02 * m[11]),
+            c10, c11, c12, -(c10 * m[3] + c11 * m[7] + c12 * m[11]),
+            c20, c21, c22, -(c20 * m[3] + c21 * m[7] + c22 * m[11]),
+            0, 0, 0, 1
+        };
+    }
+
+    // Calculate the inverse of any invertible matrix, via an LU decomposition with partial pivoting.
+    static Mat4 generalInverse(const Mat4& in) {
+        Mat4 lu = in;
+        int perm[4] = { 0, 1, 2, 3 };
+
+        for (int col = 0; col < 4; col++) {
+            // Partial pivoting; pick the row with the largest magnitude in this column.
+            int pivot = col;
+            for (int row = col + 1; row < 4; row++)
+                if (std::abs(lu.at(row, col)) > std::abs(lu.at(pivot, col))) pivot = row;
+
+            if (lu.at(pivot, col) == 0) return identity();
+
+            if (pivot != col) {
+                std::swap(perm[pivot], perm[col]);
+                for (int i = 0; i < 4; i++)
+                    std::swap(lu.at(pivot, i), lu.at(col, i));
+            }
+
+            for (int row = col + 1; row < 4; row++) {
+                Scalar factor = lu.at(row, col) /= lu.at(col, col);
+                for (int i = col + 1; i < 4; i++)
+                    lu.at(row, i) -= factor * lu.at(col, i);
+            }
+        }
+
+        // Solve LUx = Pe for each column e of the identity.
+        Mat4 out;
+        for (int col = 0; col < 4; col++) {
+            Scalar x[4];
+            for (int row = 0; row < 4; row++) {
+                x[row] = perm[row] == col ? 1 : 0;
+                for (int i = 0; i < row; i++)
+                    x[row] -= lu.at(row, i) * x[i];
+            }
+            for (int row = 3; row >= 0; row--) {
+                for (int i = row + 1; i < 4; i++)
+                    x[row] -= lu.at(row, i) * x[i];
+                x[row] /= lu.at(row, row);
+            }
+            for (int row = 0; row < 4; row++)
+                out.at(row, col) = x[row];
+        }
+
+        return out;
+    }
+
+    // Build the matrix that transforms normals, given the inverse of an object's transform.
+    // This is the transpose of the inverse's upper-left 3x3; translation has no effect on a direction.
+    static constexpr Mat4 normalMatrix(const Mat4& inverse) {
+        const Scalar* d = inverse.data;
+        return {
+            d[0], d[4], d[8], 0,
+            d[1], d[5], d[9], 0,
+            d[2], d[6], d[10], 0,
+            0, 0, 0, 1
+        };
+    }
+
+    // A simpler way to retrieve the data at known coordinates.
+    [[nodiscard]] constexpr Scalar& at(int row, int col) {
+        return data[row * 4 + col];
+    }
+
+    [[nodiscard]] constexpr Scalar at(int row, int col) const {
+        return data[row * 4 + col];
+    }
+
+    // Compare the equality of two matrices with tolerance.
+    bool operator==(const Mat4& other) const {
+        for (int i = 0; i < 16; i++) {
+            if (!safeCompare(data[i], other.data[i]))
+                return false;
+        }
+
+        return true;
+    }
+
+    bool operator!=(const Mat4& other) const {
+        return !(*this == other);
+    }
+
+    // Matrix multiplication, written out in full so that it never loops.
+    constexpr Mat4 operator*(const Mat4& o) const {
+        const Scalar* a = data;
+        const Scalar* b = o.data;
+        return {
+            a[0] * b[0] + a[1] * b[4] + a[2] * b[8] + a[3] * b[12],
+            a[0] * b[1] + a[1] * b[5] + a[2] * b[9] + a[3] * b[13],
+            a[0] * b[2] + a[1] * b[6] + a[2] * b[10] + a[3] * b[14],
+            a[0] * b[3] + a[1] * b[7] + a[2] * b[11] + a[3] * b[15],
+
+            a[4] * b[0] + a[5] * b[4] + a[6] * b[8] + a[7] * b[12],
+            a[4] * b[1] + a[5] * b[5] + a[6] * b[9] + a[7] * b[13],
+            a[4] * b[2] + a[5] * b[6] + a[6] * b[10] + a[7] * b[14],
+            a[4] * b[3] + a[5] * b[7] + a[6] * b[11] + a[7] * b[15],
+
+            a[8] * b[0] + a[9] * b[4] + a[10] * b[8] + a[11] * b[12],
+            a[8] * b[1] + a[9] * b[5] + a[10] * b[9] + a[11] * b[13],
+            a[8] * b[2] + a[9] * b[6] + a[10] * b[10] + a[11] * b[14],
+            a[8] * b[3] + a[9] * b[7] + a[10] * b[11] + a[11] * b[15],
+
+            a[12] * b[0] + a[13] * b[4] + a[14] * b[8] + a[15] * b[12],
+            a[12] * b[1] + a[13] * b[5] + a[14] * b[9] + a[15] * b[13],
+            a[12] * b[2] + a[13] * b[6] + a[14] * b[10] + a[15] * b[14],
+            a[12] * b[3] + a[13] * b[7] + a[14] * b[11] + a[15] * b[15]
+        };
+    }
+
+    Tuple operator*(const Tuple& tup) const {
+        return {
+            data[0] * tup.x + data[1] * tup.y + data[2] * tup.z + data[3] * tup.w,
+            data[4] * tup.x + data[5] * tup.y + data[6] * tup.z + data[7] * tup.w,
+            data[8] * tup.x + data[9] * tup.y + data[10] * tup.z + data[11] * tup.w,
+            data[12] * tup.x + data[13] * tup.y + data[14] * tup.z + data[15] * tup.w
+        };
+    }
+
+    [[nodiscard]] Point toTranslation() const {
+        return { data[3], data[7], data[11] };
+    }
+
+    Mat4& setTranslation(const Point& p) {
+        data[3] = p.x;
+        data[7] = p.y;
+        data[11] = p.z;
+        return *this;
+    }
+};
+
 /**
  * Represents an arbitrary-dimensional matrix of arbitrary size.
  *
@@ -25,107 +336,94 @@ bool safeCompare(double a, double b);
  * Copy assignment and move assignment are both valid.
  *
  * Uses a single backing array to store its' data.
+ * Transforms should use Mat4 instead; this exists for general-purpose math, such as the 2x2 and 3x3 minors used in the determinant.
+ * The transform factories here are kept as shorthand, and return Mat4.
 */
 
 struct Matrix {
     // The dimension of the matrix. Only square matrices can be represented this way.
     size_t size{};
-    std::unique_ptr<double[]> data;
+    std::unique_ptr<Scalar[]> data;
 
     // Retrieve the Identity matrix. Transforms and multiplications to this are effectively null.
-    static Matrix identity() {
-        return Matrix {{
-            { 1, 0, 0, 0 },
-            { 0, 1, 0, 0 },
-            { 0, 0, 1, 0 },
-            { 0, 0, 0, 1 }
-        }};
-    }
+    static constexpr Mat4 identity() { return Mat4::identity(); }
 
     // Fetch a matrix that will translate points around by the given coordinates.
-    static Matrix translation(double x, double y, double z) {
-        return Matrix {{
-            {1, 0, 0, x},
-            {0, 1, 0, y},
-            {0, 0, 1, z},
-            {0, 0, 0, 1}
-        }};
-    }
+    static constexpr Mat4 translation(Scalar x, Scalar y, Scalar z) { return Mat4::translation(x, y, z); }
 
     // Fetch a matrix that will scale points by the given factors.
-    static Matrix scaling(double x, double y, double z) {
-        return Matrix {{
-            {x, 0, 0, 0},
-            {0, y, 0, 0},
-            {0, 0, z, 0},
-            {0, 0, 0, 1}
-        }};
-    }
-
-    // Fetch a matrix that will scale points clockwise around the X axis by the given factor (interpreted in radians)
-    static Matrix rotation_x(double factor) {
-        return Matrix {{
-            {1, 0, 0, 0},
-            {0, std::cos(factor), -std::sin(factor), 0},
-            {0, std::sin(factor), std::cos(factor), 0},
-            {0, 0, 0, 1}
-        }};
-    }
-
-    // Fetch a matrix that will scale points clockwise around the X axis by the given factor (interpreted in radians)
-    static Matrix rotation_y(double factor) {
-        return Matrix {{
-            {std::cos(factor), 0, std::sin(factor), 0},
-            {0, 1, 0, 0},
-            {-std::sin(factor), 0, std::cos(factor), 0},
-            {0, 0, 0, 1}
-        }};
-    }
-
-    // Fetch a matrix that will scale points clockwise around the X axis by the given factor (interpreted in radians)
-    static Matrix rotation_z(double factor) {
-        return Matrix {{
-            {std::cos(factor), -std::sin(factor), 0, 0},
-            {std::sin(factor), std::cos(factor), 0, 0},
-            {0, 0, 1, 0},
-            {0, 0, 0, 1}
-        }};
-    }
+    static constexpr Mat4 scaling(Scalar x, Scalar y, Scalar z) { return Mat4::scaling(x, y, z); }
+
+    // Fetch a matrix that will rotate points clockwise around the given axis by the given factor (interpreted in radians)
+    static Mat4 rotation_x(Scalar factor) { return Mat4::rotation_x(factor); }
+    static Mat4 rotation_y(Scalar factor) { return Mat4::rotation_y(factor); }
+    static Mat4 rotation_z(Scalar factor) { return Mat4::rotation_z(factor); }
 
     // Fetch a matrix that will skew / shear points in the given magnitudes.
-    static Matrix shearing(double xy, double xz, double yx, double yz, double zx, double zy) {
-        return Matrix {{
-            {1, xy, xz, 0},
-            {yx, 1, yz, 0},
-            {zx, zy, 1, 0},
-            {0, 0, 0, 1}
-        }};
-    }
-
-    static Matrix rotation(Quat& q) {
-        double x = q.x, y = q.y, z = q.z, s = q.w;
-        return Matrix { {
-            { 1 - 2*y*y - 2*z*z, 2*x*y - 2*s*z, 2*x*z + 2*s*y, 0 },
-            { 2*x*y + 2*s*z, 1 - 2*x*x - 2*z*z, 2*y*z - 2*s*x, 0 },
-            { 2*x*z - 2*s*y, 2*y*z + 2*s*x, 1 - 2*x*x - 2*y*y, 0 },
-            { 0, 0, 0, 1 }
-        }};
-    }
-
-    // Calculate the determinant of this matrix, via the Laplace Expansion.
+    static constexpr Mat4 shearing(Scalar xy, Scalar xz, Scalar yx, Scalar yz, Scalar zx, Scalar zy) {
+        return Mat4::shearing(xy, xz, yx, yz, zx, zy);
+    }
+
+    static Mat4 rotation(Quat& q) { return Mat4::rotation(q); }
+
+    // Decompose the matrix into lower and upper triangular factors, with partial pivoting, packed into one matrix.
+    // The lower factor has an implicit unit diagonal. perm receives the row each output row came from.
+    // Returns the sign of the row permutation, or 0 if the matrix is singular.
+    static int decompose(const Matrix& in, Matrix& lu, std::vector<size_t>& perm) {
+        lu = in;
+        perm.resize(in.size);
+        for (size_t i = 0; i < in.size; i++) perm[i] = i;
+
+        int sign = 1;
+        for (size_t col = 0; col < in.size; col++) {
+            size_t pivot = col;
+            for (size_t row = col + 1; row < in.size; row++)
+                if (std::abs(lu.at(row, col)) > std::abs(lu.at(pivot, col))) pivot = row;
+
+            if (lu.at(pivot, col) == 0) return 0;
+
+            if (pivot != col) {
+                swapRows(lu, col, pivot);
+                std::swap(perm[col], perm[pivot]);
+                sign = -sign;
+            }
+
+            for (size_t row = col + 1; row < in.size; row++) {
+                Scalar factor = lu.at(row, col) /= lu.at(col, col);
+                for (size_t i = col + 1; i < in.size; i++)
+                    lu.at(row, i) -= factor * lu.at(col, i);
+            }
+        }
+
+        return sign;
+    }
+
+    // Calculate the determinant of this matrix.
     // Used to check whether the matrix is invertible.
-    static double determinant(const Matrix& in) {
-        // We can only directly check a 2x2 matrix.
+    static Scalar determinant(const Matrix& in) {
+        // Small matrices have closed forms, which are exact on integer input.
         if (in.size == 2) {
             return ((in.at(0, 0) * in.at(1, 1)) - (in.at(0, 1) * in.at(1, 0)));
-        } else {
-            // The Laplace Expansion provides a recursive algorithm for calculating the determinants of larger matrices.
-            double total = 0;
-            for (size_t i = 0; i < in.size; i++) {
-                total += in.at(0, i) * Matrix::cofactor(in, 0, i);
-            }
-            return total;
         }
+
+        if (in.size == 3) {
+            return in.at(0, 0) * (in.at(1, 1) * in.at(2, 2) - in.at(1, 2) * in.at(2, 1))
+                 - in.at(0, 1) * (in.at(1, 0) * in.at(2, 2) - in.at(1, 2) * in.at(2, 0))
+                 + in.at(0, 2) * (in.at(1, 0) * in.at(2, 1) - in.at(1, 1) * in.at(2, 0));
+        }
+
+        if (in.size == 4) {
+            return Mat4::determinant(in);
+        }
+
+        // Anything larger is the product of the diagonal of its' LU decomposition.
+        Matrix lu;
+        std::vector<size_t> perm;
+        Scalar total = decompose(in, lu, perm);
+        for (size_t i = 0; i < in.size && total != 0; i++)
+            total *= lu.at(i, i);
+
+        return total;
     }
 
     // Get a copy of the matrix with the given column and row removed.
@@ -147,15 +445,15 @@ struct Matrix {
 
     // Calculate the determinant of the submatrix with the given column and row removed.
     // Part of the implementation of the Laplace Expansion for the determinant of arbitrary size matrices.
-    static double minor(const Matrix &in, size_t row, size_t col) {
+    static Scalar minor(const Matrix &in, size_t row, size_t col) {
         Matrix subMatrix = Matrix::sub(in, row, col);
         return Matrix::determinant(subMatrix);
     }
 
     // Calculate the minor, invert positivity if row + col is odd.
     // Part of the implementation of the Laplace Expansion for the determinant of arbitrary size matrices.
-    static double cofactor(const Matrix &in, size_t row, size_t col) {
-        double minor = Matrix::minor(in, row, col);
+    static Scalar cofactor(const Matrix &in, size_t row, size_t col) {
+        Scalar minor = Matrix::minor(in, row, col);
 
         if ((row + col) % 2 == 0)
             return minor;
@@ -167,83 +465,52 @@ struct Matrix {
     // Operates in-place.
     static void swapRows(const Matrix& in, int row1, int row2) {
         for (size_t i = 0; i < in.size; ++i) {
-            double temp = in.data[row1 * in.size + i];
+            Scalar temp = in.data[row1 * in.size + i];
             in.data[row1 * in.size + i] = in.data[row2 * in.size + i];
             in.data[row2 * in.size + i] = temp;
         }
     }
 
-    // A fast, highly parallel function to calculate the inverse of a matrix.
-    // See inverse below for a more visual explanation of what is going on here.
-    static Matrix fastInverse(const Matrix& mat ) {
-        int size = mat.size;
-        Matrix input_matrix = mat;
-
-        Matrix ident = Matrix::identity();
-        for (int i = 0; i < size; i++) {
-            if (input_matrix.at(i, i) == 0) {
-                // swap nearest subsequent row s.t input_matrix[i][i] != 0 after swapping
-                for (int j = i + 1; j < size; j++) {
-                    if (input_matrix.at(j, i) != 0.0) {
-                        swapRows(input_matrix, i, j);
-                        break;
-                    }
-                    if (j == size - 1) {
-                        return ident;
-                    }
-                }
-            }
-            double scale = input_matrix.at(i, i);
-#pragma omp parallel for default(none) shared(size, input_matrix, scale, ident, i)
-            for (int col = 0; col < size; col++) {
-                input_matrix.at(i, col) = input_matrix.at(i, col) / scale;
-                ident.at(i, col) = ident.at(i, col) / scale;
-            }
-            if (i < size - 1) {
-#pragma omp parallel for default(none) shared(size, input_matrix, scale, ident, i)
-                for (int row = i + 1; row < size; row++) {
-                    double factor = input_matrix.at(row, i);
-                    for (int col = 0; col < size; col++) {
-                        input_matrix.at(row, col) -= factor * input_matrix.at(i, col);
-                        ident.at(row, col) -= factor * ident.at(i, col);
-                    }
-                }
-            }
-        }
+    // Calculate the inverse of a matrix; 4x4 matrices go through Mat4, which has a closed form for affine transforms.
+    // Returns the identity if the matrix is not invertible.
+    static Matrix fastInverse(const Matrix& mat) {
+        if (mat.size == 4)
+            return Mat4::inverse(mat);
 
-        for (int zeroing_col = size - 1; zeroing_col >= 1; zeroing_col--) {
-#pragma omp parallel for default(none) shared(zeroing_col, input_matrix, size, ident)
-            for (int row = zeroing_col - 1; row >= 0; row--) {
-                double factor = input_matrix.at(row, zeroing_col);
-                for (int col = 0; col < size; col++) {
-                    input_matrix.at(row, col) -= factor * input_matrix.at(zeroing_col, col);
-                    ident.at(row, col) -= factor * ident.at(zeroing_col, col);
-                }
-            }
-        }
-        return ident;
+        return inverse(mat);
     }
 
-
     // Calculate the matrix that reverses the multiplication of the given matrix. Essentially "1/x" but for matrices.
+    // Decomposes the matrix once, then solves for each column of the identity by forward and back substitution.
+    // Returns the identity if the matrix is not invertible.
     static Matrix inverse(const Matrix& in) {
-        const double determinant = Matrix::determinant(in);
-        Matrix cofactors(in.size, in.size);
-
-        // The algorithm boils down to:
-        // 1. Create a matrix filled with the cofactors of each position of the current matrix.
-        // 2. Divide each cofactor by the determinant of the matrix.
-        // 3. Transpose the matrix (replace each row with each column).
-
-        // This loop will do it all in one go; notice that the width and height is different in each access.
-        // This will cause problems if the determinant is 0 for whatever reason, though.
-        for (size_t height = 0; height < in.size; height++) {
-            for (size_t width = 0; width < in.size; width++) {
-                cofactors.data[width * in.size + height] = Matrix::cofactor(in, height, width) / determinant;
+        Matrix out(in.size, in.size);
+
+        Matrix lu;
+        std::vector<size_t> perm;
+        if (decompose(in, lu, perm) == 0) {
+            for (size_t i = 0; i < in.size; i++)
+                out.at(i, i) = 1;
+            return out;
+        }
+
+        std::vector<Scalar> x(in.size);
+        for (size_t col = 0; col < in.size; col++) {
+            for (size_t row = 0; row < in.size; row++) {
+                x[row] = perm[row] == col ? 1 : 0;
+                for (size_t i = 0; i < row; i++)
+                    x[row] -= lu.at(row, i) * x[i];
             }
+            for (size_t row = in.size; row-- > 0;) {
+                for (size_t i = row + 1; i < in.size; i++)
+                    x[row] -= lu.at(row, i) * x[i];
+                x[row] /= lu.at(row, row);
+            }
+            for (size_t row = 0; row < in.size; row++)
+                out.at(row, col) = x[row];
         }
 
-        return cofactors;
+        return out;
     }
 
     // Transpose the matrix; columns become rows, and rows become columns.
@@ -266,14 +533,19 @@ struct Matrix {
     Matrix(int width, int height) {
         (void) height;
         size = width;
-        data = std::make_unique<double[]>(width * height);
+        data = std::make_unique<Scalar[]>(width * height);
+    }
+
+    // Widen a Mat4 into a general Matrix.
+    Matrix(const Mat4& mat) : size(4), data(std::make_unique<Scalar[]>(16)) {
+        std::copy(mat.data, mat.data + 16, data.get());
     }
 
     // Value constructor. Accepts any value core that can accept a vector of vector.
     // Example: {{ {0, 2}, {1, 0} }}
-    explicit Matrix(std::vector<std::vector<double>> newData) {
+    explicit Matrix(std::vector<std::vector<Scalar>> newData) {
         size = newData.size();
-        data = std::make_unique<double[]>(size * size);
+        data = std::make_unique<Scalar[]>(size * size);
         for (size_t y = 0; y < size; y++) {
             for (size_t x = 0; x < size; x++) {
                 data[y * size + x] = newData[y][x];
@@ -281,14 +553,13 @@ struct Matrix {
         }
     }
 
-    Matrix(const Matrix& matrix) : size(matrix.size), data(std::make_unique<double[]>(matrix.size * matrix.size)) {
+    Matrix(const Matrix& matrix) : size(matrix.size), data(std::make_unique<Scalar[]>(matrix.size * matrix.size)) {
         std::copy(matrix.data.get(), matrix.data.get() + matrix.size * matrix.size, data.get());
     }
 
     Matrix& operator=(const Matrix& matrix) {
         size = matrix.size;
-        data.release();
-        data = std::make_unique<double[]>(matrix.size * matrix.size);
+        data = std::make_unique<Scalar[]>(matrix.size * matrix.size);
 
         for (size_t y = 0; y < size; y++)
             for (size_t x = 0; x < size; x++)
@@ -298,7 +569,7 @@ struct Matrix {
     }
 
     // Override the data of this Matrix with given values.
-    Matrix& operator=(std::vector<std::vector<double>> newData) {
+    Matrix& operator=(std::vector<std::vector<Scalar>> newData) {
         size = newData.size();
         for (size_t y = 0; y < size; y++) {
             for (size_t x = 0; x < size; x++) {
@@ -309,7 +580,7 @@ struct Matrix {
     }
 
     // A simpler way to retrieve the data at known coordinates.
-    [[nodiscard]] inline double& at(int width, int height) const {
+    [[nodiscard]] inline Scalar& at(int width, int height) const {
         return data[width * size + height];
     }
 
@@ -324,7 +595,7 @@ struct Matrix {
     }
 
     // Inverted equality check.
-    bool operator!=(const Matrix& otherMatrix) {
+    bool operator!=(const Matrix& otherMatrix) const {
         return !(*this == otherMatrix);
     }
 
@@ -344,25 +615,25 @@ struct Matrix {
     }
 
     Tuple operator*(const Tuple& tup) const {
-        double x =
+        Scalar x =
                 tup.x * at(0, 0) +
                 tup.y * at(0, 1) +
                 tup.z * at(0, 2) +
                 tup.w * at(0, 3);
 
-        double y =
+        Scalar y =
                 tup.x * at(1, 0) +
                 tup.y * at(1, 1) +
                 tup.z * at(1, 2) +
                 tup.w * at(1, 3);
 
-        double z =
+        Scalar z =
                 tup.x * at(2, 0) +
                 tup.y * at(2, 1) +
                 tup.z * at(2, 2) +
                 tup.w * at(2, 3);
 
-        double w =
+        Scalar w =
                 tup.x * at(3, 0) +
                 tup.y * at(3, 1) +
                 tup.z * at(3, 2) +
@@ -371,8 +642,8 @@ struct Matrix {
         return {x, y, z, w };
     }
 
-    // Matrix division by a double.. By-The-Books.
-    Matrix operator/( const double& dbl) const {
+    // Matrix division by a scalar.. By-The-Books.
+    Matrix operator/( const Scalar& dbl) const {
         Matrix result(size, size);
 
         for (size_t row = 0; row < size; row++) {
@@ -395,9 +666,17 @@ struct Matrix {
         data[11] = p.z;
         return *this;
     }
+
+    // Narrow a 4x4 Matrix into a Mat4.
+    operator Mat4() const {
+        Mat4 out;
+        std::copy(data.get(), data.get() + 16, out.data);
+        return out;
+    }
 };
 
 std::ostream& operator<<(std::ostream& stream, const Matrix& matrix);
+std::ostream& operator<<(std::ostream& stream, const Mat4& matrix);
 
 // A simple wrapper class that allows you to print tables (such as matrices) to stdout
 struct TableFormat {
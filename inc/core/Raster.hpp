@@ -4,6 +4,7 @@
  ***************/
 
 #include <core/Tuple.hpp>
+#include <core/Trace.h>
 #include <vector>
 #include <string>
 #include <algorithm>
@@ -27,10 +28,18 @@ inline size_t clamp(int val) {
 class Color : public TupleContainer {
 public:
     // Value constructor
-    Color(double red, double green, double blue) : TupleContainer() {
+    Color(Scalar red, Scalar green, Scalar blue) : TupleContainer() {
         x = red; y = green; z = blue; w = 2;
     }
 
+    // Build a color from the arithmetic backend. The fourth component is always reset to mark this as a color.
+    static Color fromReg(Simd::Reg r) {
+        Color c { 0, 0, 0 };
+        c.setReg(r);
+        c.w = 2;
+        return c;
+    }
+
     static Color black() {
         return Color { 0, 0, 0 };
     }
@@ -40,16 +49,16 @@ public:
     }
 
     // Return the red component
-    double red() { return x; }
+    Scalar red() { return x; }
 
     // Return the green component
-    double green() { return y; }
+    Scalar green() { return y; }
 
     // Return the blue compoent
-    double blue() { return z; }
+    Scalar blue() { return z; }
 
     // Fetch the specified [red, green, blue] index.
-    double value(size_t idx) {
+    Scalar value(size_t idx) {
         return idx == 0 ? red() : 
                 idx == 1 ? green() :
                  idx == 2 ? blue() :
@@ -65,23 +74,23 @@ public:
     }
 
     // Color addition operator.
-    Color operator+(const Color& other) {
-        return {x + other.x, y + other.y, z + other.z};
+    Color operator+(const Color& other) const {
+        return Color::fromReg(Simd::add(reg(), other.reg()));
     }
 
     // Color subtraction operator.
-    Color operator-(const Color& other) {
-        return {x - other.x, y - other.y, z - other.z};
+    Color operator-(const Color& other) const {
+        return Color::fromReg(Simd::sub(reg(), other.reg()));
     }
 
-    // Color scalar multiplication operator.
-    Color operator*(const double& other) {
-        return {(x * other) > 1 ? 1 : (x * other), (y * other) > 1 ? 1 : (y * other), (z * other) > 1 ? 1 : (z * other)};
+    // Color scalar multiplication operator. Channels are clamped to 1, without branching.
+    Color operator*(const Scalar& other) const {
+        return Color::fromReg(Simd::min(Simd::mul(reg(), Simd::splat(other)), Simd::splat(1)));
     }
 
-    // Shur product operator.
-    Color operator*(const Color& other) {
-        return { (x * other.x) > 1 ? 1 : (x * other.x), (y * other.y) > 1 ? 1 : (y * other.y), (z * other.z) > 1 ? 1 : (z * other.z) };
+    // Shur product operator. Channels are clamped to 1, without branching.
+    Color operator*(const Color& other) const {
+        return Color::fromReg(Simd::min(Simd::mul(reg(), other.reg()), Simd::splat(1)));
     }
 };
 
@@ -120,8 +129,33 @@ public:
         buffer[y * width + x] = col.pack();
     }
 
-    void export_png(const std::string& fileName) {
-        stbi_write_png(fileName.c_str(), width, height, 4, buffer.get(), width * 4);
+    // Set the specified pixel to an already packed Color.
+    void set(size_t x, size_t y, uint32_t packed) {
+        if (x >= width || y >= height)
+            return;
+
+        buffer[y * width + x] = packed;
+    }
+
+    // Set every pixel in [fromX, toX) by [fromY, toY) to the same Color, clipped to the framebuffer.
+    void fill(size_t fromX, size_t fromY, size_t toX, size_t toY, Color& col) {
+        uint32_t packed = col.pack();
+        toX = std::min(toX, width);
+        toY = std::min(toY, height);
+        for (size_t y = fromY; y < toY; y++)
+            for (size_t x = fromX; x < toX; x++)
+                buffer[y * width + x] = packed;
+    }
+
+    // Direct access to a row of packed pixels, for copying whole runs at once.
+    uint32_t* row(size_t y) {
+        return buffer.get() + y * width;
+    }
+
+    // Write the image to a png file. Returns false if the file couldn't be written.
+    bool export_png(const std::string& fileName) {
+        Trace::Scope trace("export png");
+        return stbi_write_png(fileName.c_str(), width, height, 4, buffer.get(), width * 4) != 0;
     }
 
 private:
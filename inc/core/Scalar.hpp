@@ -0,0 +1,39 @@
+/***************
+ * THECURLE    *
+ *     BOUNCER *
+ ***************/
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#pragma once
+
+/**
+ * The floating point type of the math core, the geometry and the renderer.
+ *
+ * Double precision is the default, and is what reference renders and the tests use.
+ * Defining BOUNCER_SINGLE_PRECISION switches everything to float, which halves the size of tuples, matrices
+ * and intersection records, and lets a whole tuple fit in one SSE register.
+ */
+#if defined(BOUNCER_SINGLE_PRECISION)
+using Scalar = float;
+#else
+using Scalar = double;
+#endif
+
+namespace Precision {
+    // The tolerance for comparing two values, and the smallest distance we care about.
+    static constexpr Scalar epsilon = 0.001;
+
+    // The rounding error of a computed hit position, relative to the largest coordinate involved in computing it.
+    // A generous multiple of the machine epsilon, since the position comes out of a transform and a quadratic.
+    static constexpr Scalar relativeError = std::numeric_limits<Scalar>::epsilon() * 64;
+
+    // How far to push a point off a surface so that rays leaving it can't hit the same surface again.
+    // scale is the largest coordinate of the ray origin or the hit; rounding error grows with it, so the offset does too.
+    // At double precision this never exceeds epsilon in any reasonable scene; at single precision it does past ~130 units.
+    inline Scalar surfaceOffset(Scalar scale) {
+        return std::max(epsilon, scale * relativeError);
+    }
+}
@@ -0,0 +1,175 @@
+/***************
+ * THECURLE    *
+ *     BOUNCER *
+ ***************/
+
+#include <cmath>
+#include <core/Scalar.hpp>
+
+#if defined(BOUNCER_SIMD_AVX2)
+#include <immintrin.h>
+#elif defined(BOUNCER_SIMD_SSE2)
+#include <emmintrin.h>
+#endif
+
+#pragma once
+
+/**
+ * The arithmetic backend for four-wide tuples of Scalars.
+ *
+ * The backend is picked at compile time:
+ *  - BOUNCER_SIMD_AVX2 keeps a tuple of doubles in one 256-bit register.
+ *  - BOUNCER_SIMD_SSE2 splits a tuple of doubles across two 128-bit registers.
+ *  - With either of those and BOUNCER_SINGLE_PRECISION, a tuple of floats fits in one 128-bit register.
+ *  - Otherwise, plain scalar code that the compiler is free to vectorize itself.
+ *
+ * Tuples are loaded from and stored to four consecutive Scalars, so every backend has the same interface.
+ * Loads and stores are unaligned, as tuples may live inside packed structures; the tuple types themselves
+ * are aligned to 32 bytes when a SIMD backend is enabled, so in practice they never straddle a cache line.
+ */
+namespace Simd {
+
+#if defined(BOUNCER_SINGLE_PRECISION) && (defined(BOUNCER_SIMD_AVX2) || defined(BOUNCER_SIMD_SSE2))
+    static constexpr int alignment = 16;
+
+    struct Reg { __m128 v; };
+
+    inline Reg load(const float* p) { return { _mm_loadu_ps(p) }; }
+    inline void store(float* p, Reg r) { _mm_storeu_ps(p, r.v); }
+    inline Reg set(float x, float y, float z, float w) { return { _mm_set_ps(w, z, y, x) }; }
+    inline Reg splat(float d) { return { _mm_set1_ps(d) }; }
+
+    inline Reg add(Reg a, Reg b) { return { _mm_add_ps(a.v, b.v) }; }
+    inline Reg sub(Reg a, Reg b) { return { _mm_sub_ps(a.v, b.v) }; }
+    inline Reg mul(Reg a, Reg b) { return { _mm_mul_ps(a.v, b.v) }; }
+    inline Reg div(Reg a, Reg b) { return { _mm_div_ps(a.v, b.v) }; }
+    inline Reg min(Reg a, Reg b) { return { _mm_min_ps(a.v, b.v) }; }
+    inline Reg neg(Reg a) { return { _mm_xor_ps(a.v, _mm_set1_ps(-0.0f)) }; }
+
+    inline float dot3(Reg a, Reg b) {
+        __m128 p = _mm_mul_ps(a.v, b.v);
+        __m128 s = _mm_add_ss(p, _mm_shuffle_ps(p, p, _MM_SHUFFLE(1, 1, 1, 1)));
+        return _mm_cvtss_f32(_mm_add_ss(s, _mm_shuffle_ps(p, p, _MM_SHUFFLE(2, 2, 2, 2))));
+    }
+
+    inline float dot4(Reg a, Reg b) {
+        __m128 p = _mm_mul_ps(a.v, b.v);
+        __m128 s = _mm_add_ps(p, _mm_movehl_ps(p, p));
+        return _mm_cvtss_f32(_mm_add_ss(s, _mm_shuffle_ps(s, s, _MM_SHUFFLE(1, 1, 1, 1))));
+    }
+
+    // As a.yzx * b.zxy - a.zxy * b.yzx. The fourth lane is 0.
+    inline Reg cross(Reg a, Reg b) {
+        __m128 aYZX = _mm_shuffle_ps(a.v, a.v, _MM_SHUFFLE(3, 0, 2, 1));
+        __m128 bZXY = _mm_shuffle_ps(b.v, b.v, _MM_SHUFFLE(3, 1, 0, 2));
+        __m128 aZXY = _mm_shuffle_ps(a.v, a.v, _MM_SHUFFLE(3, 1, 0, 2));
+        __m128 bYZX = _mm_shuffle_ps(b.v, b.v, _MM_SHUFFLE(3, 0, 2, 1));
+        return { _mm_sub_ps(_mm_mul_ps(aYZX, bZXY), _mm_mul_ps(aZXY, bYZX)) };
+    }
+
+#elif defined(BOUNCER_SIMD_AVX2)
+    static constexpr int alignment = 32;
+
+    struct Reg { __m256d v; };
+
+    inline Reg load(const double* p) { return { _mm256_loadu_pd(p) }; }
+    inline void store(double* p, Reg r) { _mm256_storeu_pd(p, r.v); }
+    inline Reg set(double x, double y, double z, double w) { return { _mm256_set_pd(w, z, y, x) }; }
+    inline Reg splat(double d) { return { _mm256_set1_pd(d) }; }
+
+    inline Reg add(Reg a, Reg b) { return { _mm256_add_pd(a.v, b.v) }; }
+    inline Reg sub(Reg a, Reg b) { return { _mm256_sub_pd(a.v, b.v) }; }
+    inline Reg mul(Reg a, Reg b) { return { _mm256_mul_pd(a.v, b.v) }; }
+    inline Reg div(Reg a, Reg b) { return { _mm256_div_pd(a.v, b.v) }; }
+    inline Reg min(Reg a, Reg b) { return { _mm256_min_pd(a.v, b.v) }; }
+    inline Reg neg(Reg a) { return { _mm256_xor_pd(a.v, _mm256_set1_pd(-0.0)) }; }
+
+    // Sum of the products of the first three lanes.
+    inline double dot3(Reg a, Reg b) {
+        __m256d p = _mm256_mul_pd(a.v, b.v);
+        __m128d xy = _mm256_castpd256_pd128(p);
+        // Replace w with 0 so that only z is carried across.
+        __m128d z0 = _mm_move_sd(_mm_setzero_pd(), _mm256_extractf128_pd(p, 1));
+        __m128d s = _mm_add_pd(xy, z0);
+        return _mm_cvtsd_f64(_mm_add_sd(s, _mm_unpackhi_pd(s, s)));
+    }
+
+    // Sum of the products of all four lanes.
+    inline double dot4(Reg a, Reg b) {
+        __m256d p = _mm256_mul_pd(a.v, b.v);
+        __m128d s = _mm_add_pd(_mm256_castpd256_pd128(p), _mm256_extractf128_pd(p, 1));
+        return _mm_cvtsd_f64(_mm_add_sd(s, _mm_unpackhi_pd(s, s)));
+    }
+
+    // The cross product of the first three lanes, as a.yzx * b.zxy - a.zxy * b.yzx. The fourth lane is 0.
+    inline Reg cross(Reg a, Reg b) {
+        __m256d aYZX = _mm256_permute4x64_pd(a.v, _MM_SHUFFLE(3, 0, 2, 1));
+        __m256d bZXY = _mm256_permute4x64_pd(b.v, _MM_SHUFFLE(3, 1, 0, 2));
+        __m256d aZXY = _mm256_permute4x64_pd(a.v, _MM_SHUFFLE(3, 1, 0, 2));
+        __m256d bYZX = _mm256_permute4x64_pd(b.v, _MM_SHUFFLE(3, 0, 2, 1));
+        return { _mm256_sub_pd(_mm256_mul_pd(aYZX, bZXY), _mm256_mul_pd(aZXY, bYZX)) };
+    }
+
+#elif defined(BOUNCER_SIMD_SSE2)
+    static constexpr int alignment = 32;
+
+    struct Reg { __m128d xy, zw; };
+
+    inline Reg load(const double* p) { return { _mm_loadu_pd(p), _mm_loadu_pd(p + 2) }; }
+    inline void store(double* p, Reg r) { _mm_storeu_pd(p, r.xy); _mm_storeu_pd(p + 2, r.zw); }
+    inline Reg set(double x, double y, double z, double w) { return { _mm_set_pd(y, x), _mm_set_pd(w, z) }; }
+    inline Reg splat(double d) { return { _mm_set1_pd(d), _mm_set1_pd(d) }; }
+
+    inline Reg add(Reg a, Reg b) { return { _mm_add_pd(a.xy, b.xy), _mm_add_pd(a.zw, b.zw) }; }
+    inline Reg sub(Reg a, Reg b) { return { _mm_sub_pd(a.xy, b.xy), _mm_sub_pd(a.zw, b.zw) }; }
+    inline Reg mul(Reg a, Reg b) { return { _mm_mul_pd(a.xy, b.xy), _mm_mul_pd(a.zw, b.zw) }; }
+    inline Reg div(Reg a, Reg b) { return { _mm_div_pd(a.xy, b.xy), _mm_div_pd(a.zw, b.zw) }; }
+    inline Reg min(Reg a, Reg b) { return { _mm_min_pd(a.xy, b.xy), _mm_min_pd(a.zw, b.zw) }; }
+    inline Reg neg(Reg a) { return { _mm_xor_pd(a.xy, _mm_set1_pd(-0.0)), _mm_xor_pd(a.zw, _mm_set1_pd(-0.0)) }; }
+
+    inline double dot3(Reg a, Reg b) {
+        __m128d s = _mm_add_pd(_mm_mul_pd(a.xy, b.xy), _mm_move_sd(_mm_setzero_pd(), _mm_mul_pd(a.zw, b.zw)));
+        return _mm_cvtsd_f64(_mm_add_sd(s, _mm_unpackhi_pd(s, s)));
+    }
+
+    inline double dot4(Reg a, Reg b) {
+        __m128d s = _mm_add_pd(_mm_mul_pd(a.xy, b.xy), _mm_mul_pd(a.zw, b.zw));
+        return _mm_cvtsd_f64(_mm_add_sd(s, _mm_unpackhi_pd(s, s)));
+    }
+
+    // SSE2 has no cheap way to shuffle across the register pair, so the cross product stays scalar.
+    inline Reg cross(Reg a, Reg b) {
+        double ax = _mm_cvtsd_f64(a.xy), ay = _mm_cvtsd_f64(_mm_unpackhi_pd(a.xy, a.xy)), az = _mm_cvtsd_f64(a.zw);
+        double bx = _mm_cvtsd_f64(b.xy), by = _mm_cvtsd_f64(_mm_unpackhi_pd(b.xy, b.xy)), bz = _mm_cvtsd_f64(b.zw);
+        return set(ay * bz - az * by, az * bx - ax * bz, ax * by - ay * bx, 0);
+    }
+
+#else
+    static constexpr int alignment = alignof(Scalar);
+
+    struct Reg { Scalar v[4]; };
+
+    inline Reg load(const Scalar* p) { return { { p[0], p[1], p[2], p[3] } }; }
+    inline void store(Scalar* p, Reg r) { p[0] = r.v[0]; p[1] = r.v[1]; p[2] = r.v[2]; p[3] = r.v[3]; }
+    inline Reg set(Scalar x, Scalar y, Scalar z, Scalar w) { return { { x, y, z, w } }; }
+    inline Reg splat(Scalar d) { return { { d, d, d, d } }; }
+
+    inline Reg add(Reg a, Reg b) { return { { a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3] } }; }
+    inline Reg sub(Reg a, Reg b) { return { { a.v[0] - b.v[0], a.v[1] - b.v[1], a.v[2] - b.v[2], a.v[3] - b.v[3] } }; }
+    inline Reg mul(Reg a, Reg b) { return { { a.v[0] * b.v[0], a.v[1] * b.v[1], a.v[2] * b.v[2], a.v[3] * b.v[3] } }; }
+    inline Reg div(Reg a, Reg b) { return { { a.v[0] / b.v[0], a.v[1] / b.v[1], a.v[2] / b.v[2], a.v[3] / b.v[3] } }; }
+    inline Reg min(Reg a, Reg b) {
+        return { { a.v[0] < b.v[0] ? a.v[0] : b.v[0], a.v[1] < b.v[1] ? a.v[1] : b.v[1],
+                   a.v[2] < b.v[2] ? a.v[2] : b.v[2], a.v[3] < b.v[3] ? a.v[3] : b.v[3] } };
+    }
+    inline Reg neg(Reg a) { return { { -a.v[0], -a.v[1], -a.v[2], -a.v[3] } }; }
+
+    inline Scalar dot3(Reg a, Reg b) { return a.v[0] * b.v[0] + a.v[1] * b.v[1] + a.v[2] * b.v[2]; }
+    inline Scalar dot4(Reg a, Reg b) { return a.v[0] * b.v[0] + a.v[1] * b.v[1] + a.v[2] * b.v[2] + a.v[3] * b.v[3]; }
+
+    inline Reg cross(Reg a, Reg b) {
+        return { { a.v[1] * b.v[2] - a.v[2] * b.v[1], a.v[2] * b.v[0] - a.v[0] * b.v[2], a.v[0] * b.v[1] - a.v[1] * b.v[0], 0 } };
+    }
+#endif
+
+}
@@ -0,0 +1,163 @@
+/***************
+ * THECURLE    *
+ *     BOUNCER *
+ ***************/
+
+#include <core/Json.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+#pragma once
+
+/**
+ * A timeline of what the renderer spent its time on, for when a frame is slow and an average doesn't say why.
+ *
+ * Code marks out a span of work with a Trace::Scope. While tracing is on, each finished span is written to a ring
+ * buffer belonging to the thread it ran on; nothing is shared between threads, and nothing is locked but the first
+ * time a thread records anything. When a thread's ring fills, its oldest spans are overwritten, so a long trace keeps
+ * the most recent of it. While tracing is off, a scope costs one relaxed atomic load.
+ *
+ * write() dumps everything recorded so far in the Chrome trace event format, which chrome://tracing and
+ * ui.perfetto.dev both open.
+ */
+namespace Trace {
+    using Clock = std::chrono::steady_clock;
+
+    // One finished span of work. The name must outlive the trace; scopes are only ever given string literals.
+    struct Event {
+        const char* name;
+        int64_t begin;
+        int64_t end;
+    };
+
+    // The spans recorded on one thread. Only that thread writes to it; written counts every span it has ever recorded.
+    struct Ring {
+        static constexpr size_t capacity = 1 << 15;
+
+        uint32_t thread;
+        std::unique_ptr<Event[]> events { std::make_unique<Event[]>(capacity) };
+        std::atomic<uint64_t> written { 0 };
+
+        explicit Ring(uint32_t thread) : thread(thread) { }
+
+        void record(const char* name, int64_t begin, int64_t end) {
+            uint64_t n = written.load(std::memory_order_relaxed);
+            events[n % capacity] = { name, begin, end };
+            written.store(n + 1, std::memory_order_release);
+        }
+    };
+
+    class Recorder {
+    public:
+        static Recorder& get() {
+            static Recorder recorder;
+            return recorder;
+        }
+
+        [[nodiscard]] bool enabled() const {
+            return on.load(std::memory_order_relaxed);
+        }
+
+        // Start recording, forgetting anything recorded before. Only call this while tracing is off.
+        void start() {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (auto& ring : rings)
+                ring->written.store(0, std::memory_order_relaxed);
+            epoch = Clock::now();
+            on.store(true, std::memory_order_release);
+        }
+
+        void stop() {
+            on.store(false, std::memory_order_release);
+        }
+
+        // Nanoseconds since recording started.
+        [[nodiscard]] int64_t now() const {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - epoch).count();
+        }
+
+        // The ring of the calling thread, made the first time it's needed.
+        Ring& ring() {
+            thread_local Ring* mine = nullptr;
+            if (!mine) {
+                std::lock_guard<std::mutex> lock(mutex);
+                rings.emplace_back(std::make_unique<Ring>((uint32_t) rings.size()));
+                mine = rings.back().get();
+            }
+            return *mine;
+        }
+
+        // Write every span recorded so far as a Chrome trace. Threads may carry on recording while it's written; any span
+        // they overwrite while it's being copied out is left out rather than written torn.
+        void write(std::ostream& out) {
+            std::lock_guard<std::mutex> lock(mutex);
+            // Times are in microseconds, to the nanosecond.
+            std::ios::fmtflags flags = out.flags();
+            std::streamsize precision = out.precision();
+            out << std::fixed << std::setprecision(3) << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+            bool first = true;
+            uint64_t dropped = 0;
+            std::vector<Event> copied;
+
+            for (auto& ring : rings) {
+                uint64_t end = ring->written.load(std::memory_order_acquire);
+                uint64_t begin = end > Ring::capacity ? end - Ring::capacity : 0;
+                copied.assign(Ring::capacity, {});
+                for (uint64_t i = begin; i < end; i++)
+                    copied[i % Ring::capacity] = ring->events[i % Ring::capacity];
+                // Anything the thread has lapped since is no longer the span that was read. The slot of the oldest one left
+                // may be getting written with the thread's next span right now, so it's dropped too.
+                uint64_t after = ring->written.load(std::memory_order_acquire);
+                if (after >= Ring::capacity) begin = std::max(begin, after - Ring::capacity + 1);
+                dropped += begin;
+
+                out << (first ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << ring->thread <<
+                        ",\"args\":{\"name\":\"thread " << ring->thread << "\"}}";
+                first = false;
+                for (uint64_t i = begin; i < end; i++) {
+                    const Event& e = copied[i % Ring::capacity];
+                    out << ",\n{\"name\":" << jsonString(e.name) << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << ring->thread <<
+                            ",\"ts\":" << (double) e.begin / 1000 << ",\"dur\":" << (double) (e.end - e.begin) / 1000 << "}";
+                }
+            }
+
+            out << "\n],\"otherData\":{\"dropped\":" << dropped << "}}" << std::endl;
+            out.flags(flags);
+            out.precision(precision);
+        }
+
+    private:
+        std::atomic<bool> on { false };
+        Clock::time_point epoch = Clock::now();
+        // Held while a thread's ring is made, and while the trace is started or written.
+        std::mutex mutex;
+        // Rings are kept after their threads end, so a trace still shows what they did.
+        std::vector<std::unique_ptr<Ring>> rings;
+    };
+
+    // Records the span from its construction to its destruction, under the given name, if tracing is on when it starts.
+    class Scope {
+    public:
+        explicit Scope(const char* name) : name(name), begin(Recorder::get().enabled() ? Recorder::get().now() : -1) { }
+
+        ~Scope() {
+            if (begin < 0) return;
+            Recorder& recorder = Recorder::get();
+            recorder.ring().record(name, begin, recorder.now());
+        }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        const char* name;
+        int64_t begin;
+    };
+}
@@ -8,6 +8,7 @@
 #include <string>
 #include <sstream>
 #include <vector>
+#include <core/Simd.hpp>
 
 #pragma once
 
@@ -16,16 +17,28 @@
  * The parent of all tuple structures
  * 
  * Not to be used directly. Use a subclass.
+ *
+ * The four components are laid out consecutively, so that the arithmetic in Simd.hpp can load them as one register.
  */
-struct TupleContainer {
-    double x;
-    double y;
-    double z;
-    double w;
+struct alignas(Simd::alignment) TupleContainer {
+    Scalar x;
+    Scalar y;
+    Scalar z;
+    Scalar w;
+
+    // Load all four components into the arithmetic backend.
+    [[nodiscard]] Simd::Reg reg() const {
+        return Simd::load(&x);
+    }
+
+    // Overwrite all four components from the arithmetic backend.
+    void setReg(Simd::Reg r) {
+        Simd::store(&x, r);
+    }
 
     // Compare two doubles with tolerance.
-    bool safeCompare(double a, double b) const {
-        return std::abs(a - b) < 0.001;
+    bool safeCompare(Scalar a, Scalar b) const {
+        return std::abs(a - b) < Precision::epsilon;
     }
 
     // Overloaded equality operator, to account for the weirdness of the 4 dimensions.
@@ -44,16 +57,19 @@ struct TupleContainer {
 class Tuple : public TupleContainer {
 public:
     // Value constructor. Set all values implicitly.
-    Tuple(double a, double b, double c, double d) : TupleContainer() {
+    Tuple(Scalar a, Scalar b, Scalar c, Scalar d) : TupleContainer() {
         x = a; y = b; z = c; w = d;
     }
 
-    explicit Tuple(std::vector<double> data) : TupleContainer() {
+    explicit Tuple(std::vector<Scalar> data) : TupleContainer() {
         x = data[0]; y = data[1]; z = data[2]; w = data[3];
     }
 
-    Tuple(Tuple& other) {
-        x = other.x; y = other.y; z = other.z; w = other.w;
+    // Build a tuple from the arithmetic backend.
+    static Tuple fromReg(Simd::Reg r) {
+        Tuple t;
+        t.setReg(r);
+        return t;
     }
 
     // Returns true if this tuple represents a location.
@@ -61,28 +77,28 @@ public:
     // Returns true if this tuple represents a direction and magnitude vector.
     bool isVector() { return w == 0; }
 
-    // Overloaded addition operator. Have to add each element individually.
-    Tuple operator+(const Tuple& other) {
-        return {other.x + x, other.y + y, other.z + z, other.w + w};
+    // Overloaded addition operator. Adds each element.
+    Tuple operator+(const Tuple& other) const {
+        return Tuple::fromReg(Simd::add(reg(), other.reg()));
     }
 
-    // Overloaded multiplication operator. Have to multiply each element individually.
-    Tuple operator*(const double& dub) {
-        return {x * dub, y * dub, z * dub, w * dub};
+    // Overloaded multiplication operator. Multiplies each element.
+    Tuple operator*(const Scalar& dub) const {
+        return Tuple::fromReg(Simd::mul(reg(), Simd::splat(dub)));
     }
     
-    // Overloaded division operator. Have to divide each element individually.
-    Tuple operator/(const double& dub) {
-        return {x / dub, y / dub, z / dub, w / dub};
+    // Overloaded division operator. Divides each element.
+    Tuple operator/(const Scalar& dub) const {
+        return Tuple::fromReg(Simd::div(reg(), Simd::splat(dub)));
     }
-    // Overloaded negation operator. Have to negate each element individually.
-    Tuple operator-() {
-        return {-x, -y, -z, -w};
+    // Overloaded negation operator. Negates each element.
+    Tuple operator-() const {
+        return Tuple::fromReg(Simd::neg(reg()));
     }
 
     // Return the absolute magnitude of this vector from start-finish.
-    double magnitude() {
-        return sqrt((x*x) + (y*y) + (z*z) + (w*w));
+    [[nodiscard]] Scalar magnitude() const {
+        return std::sqrt(Simd::dot4(reg(), reg()));
     }
 
     // Default constructor for subclasses
@@ -96,8 +112,8 @@ public:
 class Vector : public Tuple {
     public:
     // Compare two doubles with tolerance.
-    bool safeCompare(double a, double b) const {
-        return std::abs(a - b) < 0.001;
+    bool safeCompare(Scalar a, Scalar b) const {
+        return std::abs(a - b) < Precision::epsilon;
     }
 
 // Overloaded equality operator to safe-compare the components.
@@ -107,31 +123,27 @@ class Vector : public Tuple {
     }
 
     // Vector subtraction overload.
-    Vector operator-(const Vector& other) {
-        return {x - other.x, y - other.y, z - other.z};
+    Vector operator-(const Vector& other) const {
+        return Vector::fromReg(Simd::sub(reg(), other.reg()));
     }
 
-    Vector operator-() {
-        return { -x, -y, -z };
+    Vector operator-() const {
+        return Vector::fromReg(Simd::neg(reg()));
     }
 
     // Vector dot-product overload.
-    double operator*(const Vector& other) {
-        return x * other.x +
-                 y * other.y +
-                 z * other.z;
+    Scalar operator*(const Vector& other) const {
+        return Simd::dot3(reg(), other.reg());
     }
 
     // Multiply components by scalar
-    Vector operator*(const double& other) {
-        return { x * other, y * other, z * other };
+    Vector operator*(const Scalar& other) const {
+        return Vector::fromReg(Simd::mul(reg(), Simd::splat(other)));
     }
 
     // Calculate the cross-product of this and the passed vector.
-    Vector cross(const Vector& other) {
-        return {y * other.z - z * other.y,
-                z * other.x - x * other.z,
-                x * other.y - y * other.x};
+    [[nodiscard]] Vector cross(const Vector& other) const {
+        return Vector::fromReg(Simd::cross(reg(), other.reg()));
     }
 
     // Tuple copy-constructor.
@@ -139,33 +151,31 @@ class Vector : public Tuple {
         x=other.x; y=other.y; z=other.z; w=0;
     }
 
-    // Vector value constructor.
-    Vector(double a, double b, double c) {
-        x=a; y=b; z=c; w=0;
-    }
-
-    // Vector copy-constructor
-    Vector(const Vector& other) : Tuple() {
-        x = other.x; y = other.y; z = other.z; w = 0;
+    // Build a vector from the arithmetic backend. The w component is always discarded.
+    static Vector fromReg(Simd::Reg r) {
+        Vector v { 0, 0, 0 };
+        v.setReg(r);
+        v.w = 0;
+        return v;
     }
 
-    Vector& operator=(const Vector& other) {
-        x = other.x; y = other.y; z = other.z; w = 0;
-        return *this;
+    // Vector value constructor.
+    Vector(Scalar a, Scalar b, Scalar c) {
+        x=a; y=b; z=c; w=0;
     }
 
     // Normalize this vector to a unit vector.
-    Tuple normalize() {
-        double mag = magnitude();
-        if(mag < 0.001)
+    [[nodiscard]] Tuple normalize() const {
+        Scalar mag = magnitude();
+        if(mag < Precision::epsilon)
             return {0, 0, 0, 0};
 
-        return {x / mag, y / mag, z / mag, w};
+        return Tuple::fromReg(Simd::div(reg(), Simd::splat(mag)));
     }
 
     // Reflect this vector around the given normal.
-    Vector reflect(Vector normal) {
-        return *this - normal * 2 * (*this * normal);
+    [[nodiscard]] Vector reflect(const Vector& normal) const {
+        return *this - normal * (2 * (*this * normal));
     }
 };
 
@@ -175,8 +185,8 @@ class Vector : public Tuple {
 class Point : public Tuple {
     public:
     // Compare two doubles with tolerance.
-    bool safeCompare(double a, double b) const {
-        return std::abs(a - b) < 0.001;
+    bool safeCompare(Scalar a, Scalar b) const {
+        return std::abs(a - b) < Precision::epsilon;
     }
 
     // Overloaded equality operator to safe-compare the components.
@@ -188,17 +198,17 @@ class Point : public Tuple {
     // Point - Point subtraction overload. 
     // Returns a vector that leads from one point to the other.
     Vector operator-(const Point& other) const {
-        return {x - other.x, y - other.y, z - other.z};
+        return Vector::fromReg(Simd::sub(reg(), other.reg()));
     }
     
     // Point - Vector subtraction overload.
     // Returns the Point calculated by moving this Point by the given Vector.
     Point operator-(const Vector& other) const {
-        return {x - other.x, y - other.y, z - other.z};
+        return Point(Tuple::fromReg(Simd::sub(reg(), other.reg())));
     }
 
     // Point value constructor.
-    Point(double a, double b, double c) {
+    Point(Scalar a, Scalar b, Scalar c) {
         x=a; y=b; z=c; w=1;
     }
 
@@ -207,14 +217,6 @@ class Point : public Tuple {
         x=other.x; y=other.y; z=other.z; w=1;
     }
 
-    Point(Point& other) : Tuple(other) {
-        x = other.x; y = other.y; z = other.z; w = 1;
-    }
-
-    Point& operator=(const Point& other) {
-        x = other.x; y = other.y; z = other.z; w = 1;
-        return *this;
-    };
 };
 
 
@@ -225,12 +227,12 @@ class Point : public Tuple {
 class Quat : public Tuple {
 public:
     // Value constructor. Set all values implicitly.
-    Quat(double s, double x, double y, double z) : Tuple(x,y,z,s) {}
+    Quat(Scalar s, Scalar x, Scalar y, Scalar z) : Tuple(x,y,z,s) {}
 
     // Build a quat relative to the given point on the unit sphere.
     static Quat of(Point& p) {
         auto v = (Vector) p;
-        double dist = v*v;
+        Scalar dist = v*v;
         if (dist <= 1.0f)
             return {0.0, p.x, p.y, std::sqrt(1.0f - dist)};
         else
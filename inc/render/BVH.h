@@ -0,0 +1,181 @@
+/***************
+ * THECURLE    *
+ *     BOUNCER *
+ ***************/
+
+#include <core/Matrix.h>
+#include <render/Ray.h>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#pragma once
+
+struct Geo;
+
+/**
+ * An axis-aligned bounding box, in whatever space the caller decides.
+ * A default-constructed box is empty; extending it with anything produces a valid box.
+ *
+ * Stored as raw Scalars rather than Points, so that it can be copied around freely during the BVH build.
+ */
+struct Bounds {
+    Scalar min[3] = { std::numeric_limits<Scalar>::infinity(), std::numeric_limits<Scalar>::infinity(), std::numeric_limits<Scalar>::infinity() };
+    Scalar max[3] = { -std::numeric_limits<Scalar>::infinity(), -std::numeric_limits<Scalar>::infinity(), -std::numeric_limits<Scalar>::infinity() };
+
+    // A box that covers all of space. Used by geometry that has no finite extent, such as planes.
+    static Bounds infinite() {
+        Bounds b;
+        for (int i = 0; i < 3; i++) {
+            b.min[i] = -std::numeric_limits<Scalar>::infinity();
+            b.max[i] = std::numeric_limits<Scalar>::infinity();
+        }
+        return b;
+    }
+
+    [[nodiscard]] bool isInfinite() const {
+        for (int i = 0; i < 3; i++)
+            if (std::isinf(min[i]) || std::isinf(max[i])) return true;
+        return false;
+    }
+
+    // Grow this box to contain the given point.
+    void extend(Scalar x, Scalar y, Scalar z) {
+        min[0] = std::min(min[0], x); max[0] = std::max(max[0], x);
+        min[1] = std::min(min[1], y); max[1] = std::max(max[1], y);
+        min[2] = std::min(min[2], z); max[2] = std::max(max[2], z);
+    }
+
+    // Grow this box to contain the given box.
+    void extend(const Bounds& other) {
+        for (int i = 0; i < 3; i++) {
+            min[i] = std::min(min[i], other.min[i]);
+            max[i] = std::max(max[i], other.max[i]);
+        }
+    }
+
+    [[nodiscard]] bool isEmpty() const {
+        return min[0] > max[0] || min[1] > max[1] || min[2] > max[2];
+    }
+
+    // Whether the two boxes share any space; touching counts.
+    [[nodiscard]] bool overlaps(const Bounds& other) const {
+        for (int i = 0; i < 3; i++)
+            if (min[i] > other.max[i] || other.min[i] > max[i]) return false;
+        return true;
+    }
+
+    [[nodiscard]] Scalar centroid(int axis) const {
+        return (min[axis] + max[axis]) * 0.5;
+    }
+
+    // The surface area of the box; the probability weight used by the Surface Area Heuristic.
+    [[nodiscard]] Scalar surfaceArea() const {
+        Scalar dx = max[0] - min[0], dy = max[1] - min[1], dz = max[2] - min[2];
+        if (dx < 0 || dy < 0 || dz < 0) return 0;
+        return 2 * (dx * dy + dy * dz + dz * dx);
+    }
+
+    // Transform the box by the given matrix, returning a box that contains all eight transformed corners.
+    [[nodiscard]] Bounds transform(const Mat4& m) const {
+        if (isInfinite()) return *this;
+
+        Bounds out;
+        for (int corner = 0; corner < 8; corner++) {
+            Tuple t = m * Tuple(corner & 1 ? max[0] : min[0], corner & 2 ? max[1] : min[1], corner & 4 ? max[2] : min[2], 1);
+            out.extend(t.x, t.y, t.z);
+        }
+        return out;
+    }
+
+    // The slab test. Returns whether the ray given as origin and reciprocal direction passes through the box at any time in [tMin, tMax],
+    // and if so, the time it enters the box (clamped to tMin) in tEntry.
+    [[nodiscard]] bool intersect(const Scalar origin[3], const Scalar invDir[3], Scalar tMin, Scalar tMax, Scalar& tEntry) const {
+        Scalar tNear = tMin;
+        Scalar tFar = tMax;
+        for (int i = 0; i < 3; i++) {
+            Scalar t0 = (min[i] - origin[i]) * invDir[i];
+            Scalar t1 = (max[i] - origin[i]) * invDir[i];
+            if (t0 > t1) std::swap(t0, t1);
+            // Written so that NaNs (0 * inf, from an axis-parallel ray on a slab boundary) never shrink the interval.
+            tNear = t0 > tNear ? t0 : tNear;
+            tFar = t1 < tFar ? t1 : tFar;
+            if (tNear > tFar) return false;
+        }
+        tEntry = tNear;
+        return true;
+    }
+
+    [[nodiscard]] bool intersect(const Scalar origin[3], const Scalar invDir[3], Scalar tMin, Scalar tMax) const {
+        Scalar tEntry;
+        return intersect(origin, invDir, tMin, tMax, tEntry);
+    }
+};
+
+/**
+ * A Bounding Volume Hierarchy over the world-space bounds of a set of Geo.
+ *
+ * Built top-down with a binned Surface Area Heuristic, with large subtrees built in parallel as OpenMP tasks.
+ * Geometry with infinite bounds (ie. planes) can't be placed in the tree, so it's kept aside and always tested.
+ *
+ * The hierarchy only holds pointers to the Geo; if an object is moved, the tree must be rebuilt.
+ */
+struct BVH {
+    // A single node of the flattened tree.
+    // Interior nodes have count == 0, and their children are stored next to each other at offset and offset + 1.
+    // Leaf nodes reference count primitives starting at offset.
+    struct Node {
+        Bounds box;
+        uint32_t offset = 0;
+        uint32_t count = 0;
+    };
+
+    // The most nodes a traversal keeps waiting to be visited. Each node visited leaves at most one sibling behind on the
+    // stack, so no node may be deeper than stackDepth - 1 below the root.
+    static constexpr size_t stackDepth = 64;
+
+    std::vector<Node> nodes;
+    // The bounded objects, in leaf order.
+    std::vector<Geo*> prims;
+    // Objects that can't be bounded, which are tested against every ray.
+    std::vector<Geo*> unbounded;
+
+    // Rebuild the hierarchy over the given objects, discarding whatever was there before.
+    void build(Geo* const* objects, size_t count);
+
+    // Append every intersection inside the ray's interval, with geometry whose bounds it passes through.
+    void intersect(RT::Ray& r, RT::Intersections& s) const;
+
+    // Find the nearest intersection inside the ray's interval, pulling in the ray's tMax as it goes.
+    // Children are visited nearest-first, so most of the tree is culled once the first hit is found.
+    // Returns an empty intersection if nothing is hit.
+    RT::Intersection closestHit(RT::Ray& r) const;
+
+    // Whether anything blocks the ray in [0, tMax). Stops at the first blocker found, in no particular order.
+    bool occluded(RT::Ray& r, Scalar tMax) const;
+
+    [[nodiscard]] bool empty() const {
+        return nodes.empty() && unbounded.empty();
+    }
+
+private:
+    // The working data for a single primitive during the build.
+    struct BuildPrim {
+        Bounds box;
+        Scalar centroid[3];
+        Geo* object;
+    };
+
+    // Subtrees smaller than this are built on the current thread.
+    static constexpr size_t parallelThreshold = 1024;
+    // Leaves are never split if they hold this many primitives or fewer.
+    static constexpr size_t minLeafSize = 2;
+    // Leaves are always split if they hold more than this, even if the SAH would rather not.
+    static constexpr size_t maxLeafSize = 8;
+    static constexpr int binCount = 16;
+    // Past this depth, nodes are split evenly rather than by SAH, so that the tree never outgrows the traversal stack.
+    static constexpr int maxSAHDepth = 40;
+
+    void buildNode(std::vector<BuildPrim>& work, std::atomic<uint32_t>& nodesUsed, uint32_t nodeIdx, size_t begin, size_t end, int depth);
+};
@@ -8,6 +8,8 @@
 #include <core/Matrix.h>
 #include <render/Light.h>
 #include <render/Ray.h>
+#include <render/BVH.h>
+#include <render/RenderStats.h>
 
 #pragma once
 
@@ -23,9 +25,11 @@ struct Geo {
     // A reference for where the object's center is located. Used for object manipulation.
     Point center;
     // Transformation of this object; determines how it is moved and rotated relative to the world origin.
-    Matrix transform;
+    Mat4 transform;
     // Inverse transformation; determines how the world must be moved and rotated relative to the object.
-    Matrix inverseTransform;
+    Mat4 inverseTransform;
+    // The inverse-transpose of the transformation; carries object-space normals back out to world space.
+    Mat4 normalTransform;
     // Render material detail. Determines how it is rendered and the effect of various lighting calculations.
     Material material;
 
@@ -33,14 +37,17 @@ struct Geo {
         static int ids = 0;
         id = ids++;
 
-        transform = Matrix::identity();
-        inverseTransform = Matrix::identity();
+        transform = Mat4::identity();
+        inverseTransform = Mat4::identity();
+        normalTransform = Mat4::identity();
         material = Material();
     }
 
     explicit Geo(int nid) : center { 0, 0, 0 } {
         id = nid;
-        transform = Matrix::identity();
+        transform = Mat4::identity();
+        inverseTransform = Mat4::identity();
+        normalTransform = Mat4::identity();
         material = Material();
     }
 
@@ -50,10 +57,11 @@ struct Geo {
     };
 
 
-    void setMatrix(const Matrix& mat) {
+    void setMatrix(const Mat4& mat) {
         if (!(mat == transform))
             transform = mat;
-        inverseTransform = Matrix::fastInverse(mat);
+        inverseTransform = Mat4::inverse(mat);
+        normalTransform = Mat4::normalMatrix(inverseTransform);
 
         center = getCenter();
     }
@@ -66,11 +74,56 @@ struct Geo {
         return transform == x.transform && material == x.material;
     }
 
+    // Get the box that contains the untransformed object. Unbounded objects return Bounds::infinite().
+    [[nodiscard]] virtual Bounds localBounds() const = 0;
+
+    // Get the box that contains the object, in world space.
+    // Intersection happens through inverseTransform, so that's what is bounded, rather than transform.
+    [[nodiscard]] Bounds worldBounds() const {
+        return localBounds().transform(Mat4::inverse(inverseTransform));
+    }
+
     // Get the normal vector at the given point on the object.
     virtual Vector normalAt(const Point& p) = 0;
 
-    // For raytracing; append all intersections with the given ray to the given vector.
-    virtual void intersect(RT::Ray& r, std::vector<RT::Intersection>& s) = 0;
+    // For raytracing; append all intersections inside the ray's interval to the given list. The list is left unsorted.
+    virtual void intersect(RT::Ray& r, RT::Intersections& s) = 0;
+
+    // For closest-hit queries; if the ray hits this object inside its interval, record the nearest such hit in closest,
+    // and pull the ray's tMax in to it so that everything further away is rejected from then on.
+    // Subclasses should override this to skip building a list.
+    virtual bool intersectClosest(RT::Ray& r, RT::Intersection& closest) {
+        RT::Intersections found;
+        intersect(r, found);
+
+        bool hit = false;
+        for (const RT::Intersection& i : found) {
+            if (!hit || i.time < closest.time) {
+                closest = i;
+                hit = true;
+            }
+        }
+
+        if (hit) r.tMax = closest.time;
+        return hit;
+    }
+
+    // For shadows; whether the ray hits this object at any time in [0, tMax).
+    // Subclasses should override this to return as soon as they know, without building a list.
+    virtual bool occludes(RT::Ray& r, Scalar tMax) {
+        RT::Intersections found;
+        intersect(r, found);
+        for (const RT::Intersection& i : found)
+            if (i.time >= 0 && i.time < tMax) return true;
+        return false;
+    }
+
+    // Append all intersections with the given ray to the given vector, for callers that want to hold onto them.
+    void intersect(RT::Ray& r, std::vector<RT::Intersection>& s) {
+        RT::Intersections found;
+        intersect(r, found);
+        s.insert(s.end(), found.begin(), found.end());
+    }
 };
 
 /**
@@ -98,16 +151,54 @@ struct Sphere : public Geo {
         material = mat;
     }
 
-    explicit Sphere(const Matrix& trans) {
-        transform = trans;
-        inverseTransform = Matrix::fastInverse(trans);
+    explicit Sphere(const Mat4& trans) {
+        setMatrix(trans);
     }
 
     const char* getName() const override {
         return "Sphere";
     }
 
-    void intersect(RT::Ray& r, std::vector<RT::Intersection>& s) override {
+    [[nodiscard]] Bounds localBounds() const override {
+        Bounds b;
+        b.extend(-1, -1, -1);
+        b.extend(1, 1, 1);
+        return b;
+    }
+
+    using Geo::intersect;
+    void intersect(RT::Ray& r, RT::Intersections& s) override {
+        Scalar near, far;
+        if (!solve(r, near, far)) return;
+
+        if (r.accepts(near)) s.emplace_back(near, this);
+        if (r.accepts(far)) s.emplace_back(far, this);
+    }
+
+    bool intersectClosest(RT::Ray& r, RT::Intersection& closest) override {
+        Scalar near, far;
+        if (!solve(r, near, far)) return false;
+
+        // The near root is always the closer of the two, so only look at the far one if the near one is out of the interval.
+        Scalar t = r.accepts(near) ? near : far;
+        if (!r.accepts(t)) return false;
+
+        r.tMax = t;
+        closest = { t, this };
+        return true;
+    }
+
+    bool occludes(RT::Ray& r, Scalar tMax) override {
+        Scalar near, far;
+        if (!solve(r, near, far)) return false;
+
+        return (near >= 0 && near < tMax) || (far >= 0 && far < tMax);
+    }
+
+    // Solve for the times at which the ray enters and leaves the sphere. Returns false if it misses entirely.
+    bool solve(RT::Ray& r, Scalar& near, Scalar& far) const {
+        RenderStats::count(RenderStats::SphereTests);
+
         // Transform the ray according to the object's properties
         RT::Ray r2 = RT::Ray::transform(r, inverseTransform);
 
@@ -116,18 +207,18 @@ struct Sphere : public Geo {
 
         Vector delta = r2.origin - Point(0, 0, 0);
 
-        double a = r2.direction * r2.direction;
-        double b = 2 * (r2.direction * delta);
-        double c = (delta * delta) - 1;
+        Scalar a = r2.direction * r2.direction;
+        Scalar b = 2 * (r2.direction * delta);
+        Scalar c = (delta * delta) - 1;
 
         // a, b and c have left us with a quadratic formula to solve.
         // We either have 0, 1 or 2 solutions.
         // Calculate the discriminant b^2 - 4ac to determine how many solutions there are.
-        double discriminant = (b * b) - 4 * a * c;
+        Scalar discriminant = (b * b) - 4 * a * c;
 
         // If the discriminant is negative, there is no intersection
         if (discriminant < 0) {
-            return;
+            return false;
         }
 
         // If the discriminant is 0 or positive, there is at least one intersection.
@@ -135,20 +226,18 @@ struct Sphere : public Geo {
         // If the ray is tangent to the sphere, both will return the same value.
         // This keeps the ordering of intersections.
 
-        RT::Intersection intersection1 = {(-b - std::sqrt(discriminant)) / (2 * a), this};
-        RT::Intersection intersection2 = {(-b + std::sqrt(discriminant)) / (2 * a), this};
-
-        s.emplace_back(intersection1);
-        s.emplace_back(intersection2);
+        near = (-b - std::sqrt(discriminant)) / (2 * a);
+        far = (-b + std::sqrt(discriminant)) / (2 * a);
+        return true;
     }
 
     // The normal of a sphere is the opposite of the vector leading from the point to the origin.
-    // We subtract the point from the origin to get the vector, then transpose the inverse matrix to account for scaling and skewing of the sphere.
+    // We subtract the point from the origin to get the vector, then apply the normal matrix to account for scaling and skewing of the sphere.
     // Normalizing this vector will return the normal of the sphere at that point.
     Vector normalAt(const Point& p) override {
         Point oP = Point(inverseTransform * p);
         Vector oN = oP - Point(0, 0, 0);
-        Vector wN = Vector(Matrix::transpose(inverseTransform) * oN);
+        Vector wN = Vector(normalTransform * oN);
         return Vector(wN.normalize());
     }
 };
@@ -165,22 +254,49 @@ struct Plane : public Geo {
     Vector normalAt(const Point &p) override {
         (void) p;
         static const Vector normal = {0, 1, 0};
-        return Vector(inverseTransform * normal);
+        return Vector(Vector(normalTransform * normal).normalize());
     }
 
     const char* getName() const override {
         return "Plane";
     }
 
+    [[nodiscard]] Bounds localBounds() const override {
+        return Bounds::infinite();
+    }
+
+    using Geo::intersect;
+
     // Intersecting the ray with a plane is simple; translate the ray, check whether it's parallel, and append the intersection.
-    void intersect(RT::Ray& r, std::vector<RT::Intersection>& s) override {
+    void intersect(RT::Ray& r, RT::Intersections& s) override {
+        RenderStats::count(RenderStats::PlaneTests);
         RT::Ray r2 = RT::Ray::transform(r, inverseTransform);
-        if (std::abs(r2.direction.y) < 0.001) return;
+        if (std::abs(r2.direction.y) < Precision::epsilon) return;
 
-        double t = -r2.origin.y / r2.direction.y;
+        Scalar t = -r2.origin.y / r2.direction.y;
+        if (r.accepts(t)) s.emplace_back(t, this);
+    }
+
+    bool intersectClosest(RT::Ray& r, RT::Intersection& closest) override {
+        RenderStats::count(RenderStats::PlaneTests);
+        RT::Ray r2 = RT::Ray::transform(r, inverseTransform);
+        if (std::abs(r2.direction.y) < Precision::epsilon) return false;
+
+        Scalar t = -r2.origin.y / r2.direction.y;
+        if (!r.accepts(t)) return false;
+
+        r.tMax = t;
+        closest = { t, this };
+        return true;
+    }
+
+    bool occludes(RT::Ray& r, Scalar tMax) override {
+        RenderStats::count(RenderStats::PlaneTests);
+        RT::Ray r2 = RT::Ray::transform(r, inverseTransform);
+        if (std::abs(r2.direction.y) < Precision::epsilon) return false;
 
-        // TODO: hotspot. 0.527s / 4.728s spent here; 11% of execution time.
-        s.emplace_back(RT::Intersection(t, this));
+        Scalar t = -r2.origin.y / r2.direction.y;
+        return t >= 0 && t < tMax;
     }
 };
 
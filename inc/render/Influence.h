@@ -0,0 +1,58 @@
+/***************
+ * THECURLE    *
+ *     BOUNCER *
+ ***************/
+
+#include <core/Tuple.hpp>
+#include <render/BVH.h>
+#include <algorithm>
+#include <vector>
+
+#pragma once
+
+struct Geo;
+
+/**
+ * What went into rendering one tile: every object its rays hit, where they were shaded, and whether any of them bounced.
+ * This is what's needed to work out whether an edit to the world could change the tile, so that only those tiles that
+ * could are traced again. See InfluenceMap.
+ *
+ * Filled in by Light::at for whichever tile is being recorded on the current thread.
+ */
+struct TileInfluence {
+    // Every object hit by a camera, reflected or refracted ray, or crossed on the way to a refracting hit.
+    std::vector<const Geo*> objects;
+    // The bounds of every shaded point. Every shadow ray from the tile starts in here.
+    Bounds points;
+    // Whether any reflected or refracted rays were traced. If so, the tile could see anything, anywhere.
+    bool secondary = false;
+    // Whether the tile has been rendered all the way to full resolution since it was last invalidated.
+    bool valid = false;
+
+    void hit(const Geo* object) {
+        if (std::find(objects.begin(), objects.end(), object) == objects.end())
+            objects.emplace_back(object);
+    }
+
+    void shaded(const Point& p) {
+        points.extend(p.x, p.y, p.z);
+    }
+
+    [[nodiscard]] bool touches(const Geo* object) const {
+        return std::find(objects.begin(), objects.end(), object) != objects.end();
+    }
+
+    // Forget everything, ready for the tile to be rendered again.
+    void clear() {
+        objects.clear();
+        points = Bounds();
+        secondary = false;
+        valid = false;
+    }
+
+    // The record being filled in on this thread, or null if nothing is being recorded.
+    static TileInfluence*& recording() {
+        thread_local TileInfluence* active = nullptr;
+        return active;
+    }
+};
@@ -12,9 +12,14 @@
 #include "Ray.h"
 
 struct World;
+struct Geo;
 
 namespace Light {
-    Color at(World& w, RT::Ray r, int countdown = 10, bool simpleMode = false);
+    // How many times a ray may be reflected or refracted before it's given up on.
+    constexpr int maxBounces = 10;
+
+    // If primary is given, the ray's closest hit is stored in it; an empty intersection if it missed.
+    Color at(World& w, RT::Ray r, int countdown = maxBounces, bool simpleMode = false, RT::Intersection* primary = nullptr);
 }
 
 // Represents a single point emitting light of a given brightness.
@@ -41,16 +46,16 @@ struct PointLight {
 struct Material {
     Color color;
     Pattern::Pattern* pattern;
-    double ambient;
-    double diffuse;
-    double specular;
-    double shininess;
-    double reflectivity;
-    double transparency;
-    double refractiveIndex;
+    Scalar ambient;
+    Scalar diffuse;
+    Scalar specular;
+    Scalar shininess;
+    Scalar reflectivity;
+    Scalar transparency;
+    Scalar refractiveIndex;
 
     Material() : color({ 1, 1, 1}), pattern(nullptr), ambient(0.1), diffuse(0.9), specular(0.9), shininess(200.0), reflectivity(0), transparency(0), refractiveIndex(1) {}
-    Material(Color col, double amb, double diff, double spec, double shin, double reflec, double trans, double refr) : color(col), pattern(nullptr), ambient(amb), diffuse(diff), specular(spec), shininess(shin), reflectivity(reflec), transparency(trans), refractiveIndex(refr) {}
+    Material(Color col, Scalar amb, Scalar diff, Scalar spec, Scalar shin, Scalar reflec, Scalar trans, Scalar refr) : color(col), pattern(nullptr), ambient(amb), diffuse(diff), specular(spec), shininess(shin), reflectivity(reflec), transparency(trans), refractiveIndex(refr) {}
 
     bool operator==(const Material& other) const {
         return color == other.color &&
@@ -60,3 +65,17 @@ struct Material {
                 shininess == other.shininess;
     }
 };
+
+namespace Light {
+    // Phong shading of a single point, optionally in shadow.
+    Color lighting(Material m, Geo* object, PointLight light, const Point& position, const Vector& eyev, const Vector& normalv, bool inShadow);
+    Color lighting(Material m, Geo* object, const PointLight& light, const Point& position, const Vector& eyev, const Vector& normalv);
+
+    // The contribution of reflective and refractive surfaces, recursing at most countdown times.
+    Color reflected(World& w, RT::IntersectionDetail details, int countdown);
+    Color refracted(World& w, RT::IntersectionDetail details, int countdown);
+
+    bool isInShadow(World& world, Point& point);
+    Scalar fresnelContribution(RT::IntersectionDetail& detail);
+    Color shadeHit(World& world, RT::IntersectionDetail& hit, int countdown);
+}
@@ -19,15 +19,16 @@ namespace Pattern {
     struct Pattern {
         Color a;
         Color b;
-        Matrix transform;
-        Matrix inverseTransform;
+        Mat4 transform;
+        Mat4 inverseTransform;
 
         // Default colors are black and white.
-        Pattern() : a(Color::white()), b(Color::black()), transform(Matrix::identity()), inverseTransform(Matrix::identity()) {}
+        Pattern() : a(Color::white()), b(Color::black()), transform(Mat4::identity()), inverseTransform(Mat4::identity()) {}
 
-        void setTransform(const Matrix& in) {
+        // Pattern transforms are affine, so this takes Mat4's closed-form inverse.
+        void setTransform(const Mat4& in) {
             transform = in;
-            inverseTransform = Matrix::fastInverse(in);
+            inverseTransform = Mat4::inverse(in);
         }
 
         virtual Color at(const Point& p) {
@@ -5,9 +5,11 @@
 
 #include <catch2/catch_test_macros.hpp>
 #include <core/Matrix.h>
+#include <limits>
 #include <list>
 #include <algorithm>
 #include <utility>
+#include <vector>
 
 #pragma once
 
@@ -17,10 +19,21 @@ namespace RT {
     struct Ray;
     struct Intersections;
 
+    // The optional parts of an IntersectionDetail. The point, normal, eye vector and over point are always filled in,
+    // since every shaded hit needs them for lighting and shadows; the rest are only worked out when asked for.
+    enum DetailNeeds : unsigned {
+        NeedsShading = 0,
+        // The reflection vector.
+        NeedsReflection = 1 << 0,
+        // The under point, and the refractive indices either side of the surface.
+        NeedsRefraction = 1 << 1,
+        NeedsEverything = NeedsReflection | NeedsRefraction
+    };
+
     // An expanded detail version of Intersection, used for rendering.
-    // Only constructed in Intersection::fillDetail.
+    // Only constructed in Intersection::fillDetail. Fields that weren't asked for are left as zero vectors, or 1 for the indices.
     struct IntersectionDetail {
-        double time;
+        Scalar time;
         Geo &object;
         Point point;
         Point overPoint;
@@ -28,14 +41,15 @@ namespace RT {
         Vector eyev;
         Vector normalv;
         Vector reflectv;
-        double refractiveIdxIncoming;
-        double refractiveIdxOutgoing;
+        // The refractive indices either side of the surface. Only worked out for transparent surfaces; 1 otherwise.
+        Scalar refractiveIdxIncoming;
+        Scalar refractiveIdxOutgoing;
         bool isInternal;
     };
 
     // An individual ray-geometry intersection. Used for collision detection.
     struct Intersection {
-        double time;
+        Scalar time;
         Geo* object;
 
         Intersection() {
@@ -43,7 +57,7 @@ namespace RT {
             object = nullptr;
         }
 
-        Intersection(double time, Geo* object) : time(time), object(object) { }
+        Intersection(Scalar time, Geo* object) : time(time), object(object) { }
 
         Intersection(const Intersection &other) = default;
 
@@ -56,47 +70,131 @@ namespace RT {
         }
 
         // Due to the One Definition Rule, this function is defined in Geometry.h
-        static IntersectionDetail fillDetail(const Intersection &i, Ray r, Intersections &sections);
+        static IntersectionDetail fillDetail(const Intersection &i, Ray r, Intersections &sections, unsigned needs = NeedsEverything);
+
+        // The details that shading this hit will actually read, going by its material.
+        [[nodiscard]] unsigned detailNeeds() const;
+    };
+
+    // Recycled storage for intersection lists that outgrow their inline buffer.
+    // Each thread keeps its own free lists, bucketed by power-of-two capacity, so that once rendering has warmed up
+    // no intersection list ever touches the heap. Buffers are only freed when their thread exits.
+    class IntersectionArena {
+    public:
+        static IntersectionArena& local() {
+            thread_local IntersectionArena arena;
+            return arena;
+        }
+
+        // Fetch a buffer with room for 2^bucket intersections.
+        Intersection* acquire(size_t bucket) {
+            std::vector<Intersection*>& list = freeLists[bucket];
+            if (list.empty()) return new Intersection[(size_t) 1 << bucket];
+
+            Intersection* buffer = list.back();
+            list.pop_back();
+            return buffer;
+        }
+
+        // Return a buffer fetched with acquire, to be reused by the next list that needs one.
+        void release(Intersection* buffer, size_t bucket) {
+            freeLists[bucket].emplace_back(buffer);
+        }
+
+        ~IntersectionArena() {
+            for (std::vector<Intersection*>& list : freeLists)
+                for (Intersection* buffer : list)
+                    delete[] buffer;
+        }
+
+        static constexpr size_t buckets = 32;
+    private:
+        std::vector<Intersection*> freeLists[buckets];
     };
 
     // A collection of Intersection objects.
+    // The first few are stored inline, which covers nearly every ray; past that, storage comes from the IntersectionArena.
+    // Move-only, so that a list is never copied by accident on the way out of World::intersect.
     struct Intersections {
+        // Enough for a ray through a handful of overlapping spheres and a floor.
+        static constexpr size_t inlineCapacity = 8;
+        // Lists up to this size are sorted with an insertion sort, which beats std::sort on nearly-sorted short input.
+        static constexpr size_t insertionSortLimit = 16;
+
         size_t size = 0;
-        std::unique_ptr<Intersection[]> isections;
+
+        Intersections() = default;
 
         template <class iter>
         Intersections(const iter start, const iter end) {
-            size = std::distance(start, end);
-            isections = std::make_unique<Intersection[]>(size);
-            std::copy(start, end, isections.get());
+            for (iter it = start; it != end; ++it)
+                push_back(*it);
             sort();
         }
 
-        Intersections(const std::initializer_list<Intersection> &init) {
-            size = init.size();
-            isections = std::make_unique<Intersection[]>(size);
-            std::copy(init.begin(), init.end(), isections.get());
-            sort();
+        Intersections(const std::initializer_list<Intersection> &init) : Intersections(init.begin(), init.end()) { }
+
+        Intersections(const Intersections &sections) = delete;
+        Intersections& operator=(const Intersections &sections) = delete;
+
+        Intersections(Intersections &&sections) noexcept {
+            take(sections);
         }
 
-        // Intersections are sorted to make determining the hit easier.
-        Intersections sort() {
-            std::sort(isections.get(), isections.get() + size,
-                      [](const Intersection &a, const Intersection &b) { return a.time < b.time; });
+        Intersections& operator=(Intersections &&sections) noexcept {
+            if (this != &sections) {
+                releaseStorage();
+                take(sections);
+            }
             return *this;
         }
 
-        Intersections() = default;
+        ~Intersections() {
+            releaseStorage();
+        }
 
-        Intersections(const Intersections &sections) : size(sections.size),
-                                                       isections(std::make_unique<Intersection[]>(sections.size)) {
-            std::copy(sections.isections.get(), sections.isections.get() + sections.size, isections.get());
+        // Append an intersection. The list is not kept sorted; call sort() once everything has been added.
+        void push_back(const Intersection &i) {
+            if (size == capacity) grow();
+            isections[size++] = i;
         }
 
-        Intersection operator [](size_t index) {
+        template <class... Args>
+        void emplace_back(Args&&... args) {
+            push_back(Intersection(std::forward<Args>(args)...));
+        }
+
+        // Forget every intersection, keeping whatever storage has been claimed.
+        void clear() {
+            size = 0;
+        }
+
+        // Intersections are sorted to make determining the hit easier.
+        Intersections& sort() {
+            auto earlier = [](const Intersection &a, const Intersection &b) { return a.time < b.time; };
+
+            if (size > insertionSortLimit) {
+                std::sort(isections, isections + size, earlier);
+                return *this;
+            }
+
+            for (size_t i = 1; i < size; i++) {
+                Intersection current = isections[i];
+                size_t j = i;
+                for (; j > 0 && earlier(current, isections[j - 1]); j--)
+                    isections[j] = isections[j - 1];
+                isections[j] = current;
+            }
+            return *this;
+        }
+
+        Intersection operator [](size_t index) const {
             return isections[index];
         }
 
+        [[nodiscard]] const Intersection* begin() const { return isections; }
+        [[nodiscard]] const Intersection* end() const { return isections + size; }
+
         // Return the lowest non-negative intersection in the list.
         // This is made easier by the sorting on construction.
         [[nodiscard]] Intersection hit() const {
@@ -107,25 +205,80 @@ namespace RT {
             return {-1, nullptr};
         }
 
+    private:
+        Intersection* isections = inlineStorage;
+        size_t capacity = inlineCapacity;
+        // The arena bucket that isections came from, or 0 while the inline storage is in use.
+        size_t bucket = 0;
+        Intersection inlineStorage[inlineCapacity];
+
+        // Double the capacity, moving from the inline storage to the arena if necessary.
+        void grow() {
+            size_t next = bucket == 0 ? 4 : bucket + 1;
+            while (((size_t) 1 << next) <= capacity) next++;
+
+            Intersection* buffer = IntersectionArena::local().acquire(next);
+            std::copy(isections, isections + size, buffer);
+            releaseStorage();
+
+            isections = buffer;
+            capacity = (size_t) 1 << next;
+            bucket = next;
+        }
+
+        void releaseStorage() {
+            if (bucket != 0) IntersectionArena::local().release(isections, bucket);
+            isections = inlineStorage;
+            capacity = inlineCapacity;
+            bucket = 0;
+        }
+
+        // Take the contents of another list, which is left empty.
+        void take(Intersections &other) {
+            size = other.size;
+            if (other.bucket != 0) {
+                isections = other.isections;
+                capacity = other.capacity;
+                bucket = other.bucket;
+            } else {
+                std::copy(other.isections, other.isections + other.size, inlineStorage);
+            }
+
+            other.isections = other.inlineStorage;
+            other.capacity = inlineCapacity;
+            other.bucket = 0;
+            other.size = 0;
+        }
     };
 
     // The ray that gives Ray Tracing its' name.
-    // Has an origin and a direction, and that's about it.
+    // Has an origin, a direction, and the interval of times [tMin, tMax] that hits are accepted in.
+    // By default that's the whole line, behind the origin included, since refraction needs to know what the ray started inside of.
+    // Closest-hit queries start from 0 and pull tMax in as they find closer hits.
     struct Ray {
         Point origin;
         Vector direction;
+        Scalar tMin = -std::numeric_limits<Scalar>::infinity();
+        Scalar tMax = std::numeric_limits<Scalar>::infinity();
 
         Ray(Point o, const Vector &d) : origin(o), direction(d) { }
+        Ray(Point o, const Vector &d, Scalar min, Scalar max) : origin(o), direction(d), tMin(min), tMax(max) { }
+
+        // Whether a hit at the given time is inside the interval.
+        [[nodiscard]] bool accepts(Scalar t) const {
+            return t >= tMin && t <= tMax;
+        }
 
         // Calculate the position of this ray after t units of travel.
-        static Point position(Ray r, double t) {
+        static Point position(Ray r, Scalar t) {
             return Point(r.origin + ((Tuple) r.direction * t));
         }
 
-        static Ray transform(const Ray &r, const Matrix &m) {
+        // The direction is not renormalized, so times along the transformed ray are the same as along the original, and so is the interval.
+        static Ray transform(const Ray &r, const Mat4 &m) {
             Point transformedOrigin = Point(m * r.origin);
             Vector transformedDir = Vector(m * r.direction);
-            return {transformedOrigin, transformedDir};
+            return {transformedOrigin, transformedDir, r.tMin, r.tMax};
         }
     };
 }
\ No newline at end of file
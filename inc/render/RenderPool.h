@@ -0,0 +1,97 @@
+/***************
+ * THECURLE    *
+ *     BOUNCER *
+ ***************/
+
+#include <render/Scheduler.h>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#pragma once
+
+/**
+ * A set of long-lived render threads, fed one frame at a time through a TileScheduler.
+ *
+ * A frame can be split into passes, which are rendered one after another; a pass is only dealt out once every tile of the
+ * one before it is finished. This is what lets a coarse pass of the whole image land before any of the fine ones start.
+ *
+ * Every frame gets a new generation number. Submitting a frame supersedes the one in flight: workers drop the rest of
+ * its tiles, and a job can check current(generation) to give up on a tile partway through.
+ * submit and cancel only return once no worker is inside a tile of an older frame, so the caller is then free to change
+ * whatever the jobs read (the world, the camera) without racing them.
+ */
+class RenderPool {
+public:
+    // Renders one tile of the given pass of the frame with the given generation.
+    using Job = std::function<void(const Tile& tile, uint64_t generation, size_t pass)>;
+
+    explicit RenderPool(size_t threadCount);
+    ~RenderPool();
+
+    RenderPool(const RenderPool&) = delete;
+    RenderPool& operator=(const RenderPool&) = delete;
+
+    // Abandon the frame in flight, if any, and start rendering the given tiles. Returns the new frame's generation.
+    uint64_t submit(const std::vector<Tile>& tiles, Job job);
+
+    // As above, but rendering each list of tiles as a pass of its own, in order.
+    uint64_t submit(std::vector<std::vector<Tile>> passes, Job job);
+
+    // Abandon the frame in flight, and wait for every worker to leave it.
+    void cancel();
+
+    // Whether the given frame is still the newest; a job should stop as soon as this is false.
+    [[nodiscard]] bool current(uint64_t frame) const {
+        return generation.load(std::memory_order_relaxed) == frame;
+    }
+
+    // Whether every tile of the given frame has been rendered.
+    [[nodiscard]] bool finished(uint64_t frame) const {
+        return completed.load(std::memory_order_acquire) == frame;
+    }
+
+    // How many passes of the newest frame are finished.
+    [[nodiscard]] size_t passesFinished() const {
+        return passesDone.load(std::memory_order_acquire);
+    }
+
+    // Block until the given frame is finished, or superseded by a newer one.
+    void wait(uint64_t frame);
+
+    [[nodiscard]] size_t threadCount() const { return threads.size(); }
+
+private:
+    void work(size_t self);
+    // Bump the generation and wait for the workers to leave the old frame. Called with the lock held.
+    void supersede(std::unique_lock<std::mutex>& lock);
+    // Deal out the next pass of the current frame, or mark it finished if there isn't one. Called with the lock held.
+    void advance();
+
+    TileScheduler scheduler;
+    std::vector<std::thread> threads;
+
+    std::mutex lock;
+    // Wakes the workers when there's a new frame, or when the pool is shutting down.
+    std::condition_variable wake;
+    // Wakes anyone waiting on a frame, when it finishes or when the last worker leaves it.
+    std::condition_variable settled;
+
+    std::atomic<uint64_t> generation { 0 };
+    std::atomic<uint64_t> completed { 0 };
+    // The tiles of the current pass that haven't been finished yet.
+    std::atomic<size_t> remaining { 0 };
+    // The pass being dealt out, and how many have been finished.
+    std::atomic<size_t> pass { 0 };
+    std::atomic<size_t> passesDone { 0 };
+    std::vector<std::vector<Tile>> passes;
+    Job job;
+    // Whether the current pass still has tiles for the taking.
+    bool open = false;
+    // How many workers are inside the current frame.
+    size_t busy = 0;
+    bool stopping = false;
+};
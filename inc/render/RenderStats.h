@@ -0,0 +1,92 @@
+/***************
+ * THECURLE    *
+ *     BOUNCER *
+ ***************/
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#pragma once
+
+/**
+ * Counts of the work that went into a render: the rays of each kind, how deep they recursed, the intersection tests made
+ * against each kind of geometry, and how many objects deep refracting rays were.
+ *
+ * Each thread counts into its own record, found through recording() the same way as TileInfluence, and World::renderRT
+ * adds them together at the end of the frame. While nothing is being recorded, counting costs a thread local load and
+ * a branch.
+ */
+struct alignas(64) RenderStats {
+    enum Counter {
+        PrimaryRays,
+        ShadowRays,
+        ReflectionRays,
+        RefractionRays,
+        SphereTests,
+        PlaneTests,
+        DetailFills,
+        CounterCount
+    };
+
+    // Rays deeper than this are counted in the last bucket of the depth histogram.
+    static constexpr size_t depthBuckets = 16;
+    // Hits more objects deep than this are counted in the last bucket of the media histogram.
+    static constexpr size_t mediaBuckets = 8;
+
+    uint64_t counters[CounterCount] {};
+    // How many rays were traced at each depth of recursion; camera rays are at depth 0.
+    uint64_t depths[depthBuckets] {};
+    // How many refracting hits were inside each number of objects, when the refractive indices were worked out.
+    uint64_t media[mediaBuckets] {};
+    // The most objects any refracting hit was inside of.
+    size_t deepestMedia = 0;
+    // How long the render took, start to end.
+    std::chrono::nanoseconds time { 0 };
+
+    [[nodiscard]] uint64_t operator[](Counter c) const {
+        return counters[c];
+    }
+
+    // Every ray traced, of any kind.
+    [[nodiscard]] uint64_t rays() const {
+        return counters[PrimaryRays] + counters[ShadowRays] + counters[ReflectionRays] + counters[RefractionRays];
+    }
+
+    // Every ray-primitive test, of any kind of geometry.
+    [[nodiscard]] uint64_t intersectionTests() const {
+        return counters[SphereTests] + counters[PlaneTests];
+    }
+
+    // Add another thread's counts to these. The time is left alone; the threads ran side by side.
+    RenderStats& operator+=(const RenderStats& other) {
+        for (size_t i = 0; i < CounterCount; i++) counters[i] += other.counters[i];
+        for (size_t i = 0; i < depthBuckets; i++) depths[i] += other.depths[i];
+        for (size_t i = 0; i < mediaBuckets; i++) media[i] += other.media[i];
+        if (other.deepestMedia > deepestMedia) deepestMedia = other.deepestMedia;
+        return *this;
+    }
+
+    static void count(Counter c) {
+        if (RenderStats* stats = recording()) stats->counters[c]++;
+    }
+
+    // Note a ray traced at the given depth of recursion.
+    static void traced(size_t depth) {
+        if (RenderStats* stats = recording()) stats->depths[depth < depthBuckets ? depth : depthBuckets - 1]++;
+    }
+
+    // Note a refracting hit inside the given number of objects.
+    static void inside(size_t objects) {
+        if (RenderStats* stats = recording()) {
+            stats->media[objects < mediaBuckets ? objects : mediaBuckets - 1]++;
+            if (objects > stats->deepestMedia) stats->deepestMedia = objects;
+        }
+    }
+
+    // The record being counted into on this thread, or null if nothing is being recorded.
+    static RenderStats*& recording() {
+        thread_local RenderStats* active = nullptr;
+        return active;
+    }
+};
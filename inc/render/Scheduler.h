@@ -0,0 +1,110 @@
+/***************
+ * THECURLE    *
+ *     BOUNCER *
+ ***************/
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+#include <omp.h>
+
+#pragma once
+
+// A rectangle of pixels, [fromX, toX) by [fromY, toY), that a worker renders in one go.
+struct Tile {
+    int fromX, fromY, toX, toY;
+
+    bool operator ==(const Tile& other) const {
+        return fromX == other.fromX && fromY == other.fromY && toX == other.toX && toY == other.toY;
+    }
+};
+
+// What one worker did over a run of the scheduler.
+struct WorkerStats {
+    // Time spent rendering tiles.
+    std::chrono::nanoseconds busy { 0 };
+    // The rest of the run; looking for work, or waiting for the other workers to finish.
+    std::chrono::nanoseconds idle { 0 };
+    size_t tiles = 0;
+    // How many of those tiles were taken from another worker.
+    size_t stolen = 0;
+};
+
+/**
+ * Hands out the tiles of an image to a team of worker threads.
+ *
+ * Tiles are ordered along a Hilbert curve, so that consecutive tiles sit next to each other on screen and touch mostly
+ * the same geometry. The curve is cut into one contiguous run per worker, which the worker takes from the front of.
+ * A worker that runs dry steals from the back of another's run; the tiles furthest from where that worker is rendering.
+ *
+ * The cost of a tile varies wildly (sky is done long before glass), so without stealing, whoever was dealt the cheap
+ * part of the image sits idle while the rest finish.
+ */
+class TileScheduler {
+public:
+    // Big enough that fetching a tile is noise next to rendering it, small enough to share the work out evenly.
+    static constexpr int defaultTileSize = 16;
+
+    // Split the region into tiles of at most tileSize square, in Hilbert order.
+    static std::vector<Tile> tile(int fromX, int fromY, int toX, int toY, int tileSize = defaultTileSize);
+
+    // The distance of cell (x, y) along a Hilbert curve filling a side by side grid. side must be a power of two.
+    static uint64_t hilbertIndex(uint32_t side, uint32_t x, uint32_t y);
+
+    explicit TileScheduler(size_t workerCount) : workers(workerCount == 0 ? 1 : workerCount) { }
+
+    [[nodiscard]] size_t workerCount() const { return workers.size(); }
+
+    // Deal the tiles out for a new run, one even contiguous run per worker. Anything left from the last run is dropped.
+    void deal(const std::vector<Tile>& tiles);
+
+    // Fetch the next tile for the given worker, stealing one if its own run is empty.
+    // Returns false once there is no work left anywhere.
+    bool next(size_t worker, Tile& out, bool& stolen);
+
+    // The stats of each worker over the last run.
+    [[nodiscard]] std::vector<WorkerStats> stats() const;
+
+    // Render every tile, calling renderTile(const Tile&) from one OpenMP thread per worker.
+    // If OpenMP gives us fewer threads than workers, the runs of the missing workers are stolen by the rest.
+    template <class F>
+    void run(const std::vector<Tile>& tiles, F&& renderTile) {
+        deal(tiles);
+        auto start = std::chrono::steady_clock::now();
+
+        #pragma omp parallel num_threads((int) workers.size())
+        {
+            size_t self = omp_get_thread_num();
+            Tile tile {};
+            bool stolen = false;
+            while (next(self, tile, stolen)) {
+                auto begin = std::chrono::steady_clock::now();
+                renderTile(tile);
+                WorkerStats& stats = workers[self].stats;
+                stats.busy += std::chrono::steady_clock::now() - begin;
+                stats.tiles++;
+                stats.stolen += stolen;
+            }
+        }
+
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        for (Worker& w : workers)
+            w.stats.idle = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed) - w.stats.busy;
+    }
+
+private:
+    static constexpr size_t cacheLine = 64;
+
+    // Padded out to a cache line, so that a worker updating its own state never stalls its neighbours.
+    struct alignas(cacheLine) Worker {
+        mutable std::mutex lock;
+        std::vector<Tile> tiles;
+        // The tiles still to be rendered are [head, tail). The owner takes from the head, thieves from the tail.
+        size_t head = 0;
+        size_t tail = 0;
+        WorkerStats stats;
+    };
+
+    std::vector<Worker> workers;
+};
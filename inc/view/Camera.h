@@ -15,11 +15,11 @@
 // Information on the origin of rays, and the view space we render to
 struct Camera {
     int horizontalSize {}, verticalSize {};
-    double halfWidth {}, halfHeight {};
-    double pixelSize {};
-    double fieldOfView {};
-    Matrix transform;
-    Matrix inverseTransform;
+    Scalar halfWidth {}, halfHeight {};
+    Scalar pixelSize {};
+    Scalar fieldOfView {};
+    Mat4 transform;
+    Mat4 inverseTransform;
 
     // A copy of the data used to derive the transform matrices, in case it needs to be changed (ie. arcball)
     Point pos { 0, 0, 0 };
@@ -28,13 +28,13 @@ struct Camera {
 
     Camera() = default;
 
-    Camera(int hSize, int vSize, double fov) {
+    Camera(int hSize, int vSize, Scalar fov) {
         horizontalSize = hSize;
         verticalSize = vSize;
         fieldOfView = fov;
 
-        double halfView = std::tan(fieldOfView / 2);
-        double aspectRatio = (double) horizontalSize / (double) verticalSize;
+        Scalar halfView = std::tan(fieldOfView / 2);
+        Scalar aspectRatio = (Scalar) horizontalSize / (Scalar) verticalSize;
 
         if (aspectRatio > 0) {
             halfWidth = halfView;
@@ -46,10 +46,12 @@ struct Camera {
 
         pixelSize = (halfWidth * 2) / horizontalSize;
 
-        transform = Matrix::identity();
-        inverseTransform = Matrix::identity();
+        transform = Mat4::identity();
+        inverseTransform = Mat4::identity();
     }
 
+    Camera(const Camera&) = default;
+
     Camera& operator=(const Camera& other) {
         horizontalSize = other.horizontalSize;
         verticalSize = other.verticalSize;
@@ -62,11 +64,12 @@ struct Camera {
         pos = other.pos;
         target = other.target;
         upVec = other.upVec;
+        return *this;
     }
 
-    void setTransform(const Matrix& mat) {
+    void setTransform(const Mat4& mat) {
         transform = mat;
-        inverseTransform = Matrix::fastInverse(mat);
+        inverseTransform = Mat4::inverse(mat);
     }
 
     void setTransform(const Point& origin, const Point& lookAt, Vector up) {
@@ -77,12 +80,12 @@ struct Camera {
     // Create a an RT Ray that will render the given pixel on the screen.
     [[nodiscard]] RT::Ray rayForPixel(int x, int y) const {
         // Start in the middle of the pixel; x+0.5,y+0.5
-        double xOffset = (x + 0.5) * pixelSize;
-        double yOffset = (y + 0.5) * pixelSize;
+        Scalar xOffset = (x + 0.5) * pixelSize;
+        Scalar yOffset = (y + 0.5) * pixelSize;
 
         // Project this point into the world, taking into account the field of view.
-        double worldX = halfWidth - xOffset;
-        double worldY = halfHeight - yOffset;
+        Scalar worldX = halfWidth - xOffset;
+        Scalar worldY = halfHeight - yOffset;
 
         // The pixel we're trying to cast through is now a known point in the world.
         Point pixel = Point(inverseTransform * Point(worldX, worldY, -1));
@@ -94,23 +97,37 @@ struct Camera {
         return RT::Ray { origin, dir };
     }
 
+    // Find the pixel that a point in the world lands on; the inverse of rayForPixel.
+    // Returns false if the point is level with or behind the camera, where it doesn't land on the screen at all.
+    // If depth is given, the distance of the point in front of the camera is stored in it.
+    bool project(const Point& p, Scalar& x, Scalar& y, Scalar* depth = nullptr) const {
+        Tuple view = transform * p;
+        if (view.z > -Precision::epsilon) return false;
+        if (depth) *depth = -view.z;
+
+        // Back onto the plane one unit in front of the camera, then from there to pixels.
+        Scalar worldX = view.x / -view.z;
+        Scalar worldY = view.y / -view.z;
+        x = (halfWidth - worldX) / pixelSize - (Scalar) 0.5;
+        y = (halfHeight - worldY) / pixelSize - (Scalar) 0.5;
+        return true;
+    }
+
     // Generate a view matrix that will place and orient the camera appropriately.
-    static Matrix viewMatrix(const Point& start, const Point& end, Vector up) {
+    static Mat4 viewMatrix(const Point& start, const Point& end, Vector up) {
         Vector forward = end - start;
         forward = Vector(forward.normalize());
 
         Vector left = forward.cross(Vector(up.normalize()));
         Vector trueUp = left.cross(forward);
 
-        Matrix orientation {
-                {
-                        { left.x, left.y, left.z, 0 },
-                        { trueUp.x, trueUp.y, trueUp.z, 0 },
-                        { -forward.x, -forward.y, -forward.z, 0 },
-                        { 0, 0, 0, 1 }
-                }
+        Mat4 orientation {
+                left.x, left.y, left.z, 0,
+                trueUp.x, trueUp.y, trueUp.z, 0,
+                -forward.x, -forward.y, -forward.z, 0,
+                0, 0, 0, 1
         };
 
-        return orientation * Matrix::translation(-start.x, -start.y, -start.z);
+        return orientation * Mat4::translation(-start.x, -start.y, -start.z);
     }
 };
\ No newline at end of file
@@ -0,0 +1,104 @@
+/***************
+ * THECURLE    *
+ *     BOUNCER *
+ ***************/
+
+#include <core/Raster.hpp>
+#include <render/Scheduler.h>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#pragma once
+
+/**
+ * A pair of framebuffers: the back one is rendered into, and the front one is what's shown.
+ *
+ * The back buffer is split into tiles, each with a version number. A render thread bumps it once when it starts on
+ * the tile, making it odd, and again when it's done, making it even. That's all it does: no locks, and no waiting.
+ * The display copies across every tile that has moved on to a new even version, then checks the version again; if a
+ * render thread got in the way, the copy is thrown out and tried again next time.
+ *
+ * So the front buffer only ever holds whole tiles, tiles appear as soon as they're finished, and the last tile of a
+ * frame flips the whole frame into view at once. The render threads and the display never touch the same pixels.
+ */
+class DoubleBuffer {
+public:
+    DoubleBuffer(int width, int height, int tileSize = TileScheduler::defaultTileSize)
+        : width(width), height(height), tileSize(tileSize),
+          columns((width + tileSize - 1) / tileSize), rows((height + tileSize - 1) / tileSize),
+          backBuffer(width, height), frontBuffer(width, height),
+          versions(std::make_unique<std::atomic<uint32_t>[]>((size_t) columns * rows)),
+          shown((size_t) columns * rows, 0), scratch((size_t) tileSize * tileSize) {
+        for (size_t i = 0; i < shown.size(); i++)
+            versions[i].store(0, std::memory_order_relaxed);
+    }
+
+    // The buffer to render into. Between beginTile and publishTile, only that tile may be written.
+    Framebuffer& back() { return backBuffer; }
+
+    // The buffer to show. Only the display thread may use it.
+    Framebuffer& front() { return frontBuffer; }
+
+    // Start writing to a tile of the back buffer, hiding it from the display until it's published.
+    void beginTile(const Tile& tile) {
+        versions[index(tile)].fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+    }
+
+    // Finish writing to a tile, and let the display show it.
+    void publishTile(const Tile& tile) {
+        versions[index(tile)].fetch_add(1, std::memory_order_release);
+    }
+
+    // The whole back buffer was changed at once. Only safe while nothing is rendering.
+    void publishAll() {
+        for (size_t i = 0; i < shown.size(); i++)
+            versions[i].fetch_add(2, std::memory_order_release);
+    }
+
+    // Copy every newly published tile into the front buffer. Returns how many were copied.
+    size_t present() {
+        size_t copied = 0;
+        for (int ty = 0; ty < rows; ty++) {
+            for (int tx = 0; tx < columns; tx++) {
+                size_t i = (size_t) ty * columns + tx;
+                uint32_t before = versions[i].load(std::memory_order_acquire);
+                if ((before & 1) != 0 || before == shown[i]) continue;
+
+                int fromX = tx * tileSize, fromY = ty * tileSize;
+                int w = std::min(tileSize, width - fromX), h = std::min(tileSize, height - fromY);
+                for (int y = 0; y < h; y++)
+                    std::memcpy(&scratch[(size_t) y * tileSize], backBuffer.row(fromY + y) + fromX, w * sizeof(uint32_t));
+
+                // If the tile was started on again while we copied it, the copy may be torn.
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (versions[i].load(std::memory_order_relaxed) != before) continue;
+
+                for (int y = 0; y < h; y++)
+                    std::memcpy(frontBuffer.row(fromY + y) + fromX, &scratch[(size_t) y * tileSize], w * sizeof(uint32_t));
+                shown[i] = before;
+                copied++;
+            }
+        }
+        return copied;
+    }
+
+private:
+    int width, height, tileSize;
+    int columns, rows;
+    Framebuffer backBuffer;
+    Framebuffer frontBuffer;
+    // Per tile, row by row; odd while a tile is being written.
+    std::unique_ptr<std::atomic<uint32_t>[]> versions;
+    // The version of each tile that's in the front buffer. Only touched by the display.
+    std::vector<uint32_t> shown;
+    // Where a tile is copied to before it's known to be whole.
+    std::vector<uint32_t> scratch;
+
+    [[nodiscard]] size_t index(const Tile& tile) const {
+        return (size_t) (tile.fromY / tileSize) * columns + (tile.fromX / tileSize);
+    }
+};
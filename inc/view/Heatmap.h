@@ -0,0 +1,118 @@
+/***************
+ * THECURLE    *
+ *     BOUNCER *
+ ***************/
+
+#include <core/Raster.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#pragma once
+
+/**
+ * How long every pixel of an image took to trace, to show where on screen the render time goes.
+ *
+ * World::renderTile times each pixel it traces into the map, if it's given one; without one, nothing is timed.
+ * Pixels are written by whichever thread traced them, and may be read while a frame is still rendering; each is an
+ * atomic, which costs nothing more than a plain store.
+ *
+ * paint draws the map in false colour, on a log scale: black for the cheapest pixels, through purple, red and yellow,
+ * to white for the most expensive. Pixels that weren't timed are black.
+ */
+class Heatmap {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    Heatmap(int width, int height)
+        : width(width), height(height), costs(std::make_unique<std::atomic<float>[]>((size_t) width * height)) {
+        clear();
+    }
+
+    // Record the time since started against every pixel in [fromX, toX) by [fromY, toY), clipped to the map.
+    // A coarse level traces one pixel for a whole block, so the whole block is put down to it.
+    void record(int fromX, int fromY, int toX, int toY, Clock::time_point started) {
+        auto ns = (float) std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - started).count();
+        toX = std::min(toX, width);
+        toY = std::min(toY, height);
+        for (int y = fromY; y < toY; y++)
+            for (int x = fromX; x < toX; x++)
+                costs[(size_t) y * width + x].store(ns, std::memory_order_relaxed);
+    }
+
+    // How long the pixel took, in nanoseconds.
+    [[nodiscard]] float at(int x, int y) const {
+        return costs[(size_t) y * width + x].load(std::memory_order_relaxed);
+    }
+
+    // The most any pixel took.
+    [[nodiscard]] float highest() const {
+        float most = 0;
+        for (size_t i = 0; i < (size_t) width * height; i++)
+            most = std::max(most, costs[i].load(std::memory_order_relaxed));
+        return most;
+    }
+
+    void clear() {
+        for (size_t i = 0; i < (size_t) width * height; i++)
+            costs[i].store(0, std::memory_order_relaxed);
+    }
+
+    // The costs that the cheapest and most expensive pixels are counted from; the 1st and 99th percentile of the ones
+    // timed, so that a pixel that happened to be interrupted by the OS doesn't wash out the rest.
+    void range(float& low, float& high) const {
+        std::vector<float> timed;
+        timed.reserve((size_t) width * height);
+        for (size_t i = 0; i < (size_t) width * height; i++) {
+            float cost = costs[i].load(std::memory_order_relaxed);
+            if (cost > 0) timed.push_back(cost);
+        }
+
+        low = high = 1;
+        if (timed.empty()) return;
+        std::nth_element(timed.begin(), timed.begin() + timed.size() / 100, timed.end());
+        low = std::max(timed[timed.size() / 100], 1.0f);
+        std::nth_element(timed.begin(), timed.begin() + timed.size() * 99 / 100, timed.end());
+        high = std::max(timed[timed.size() * 99 / 100], low);
+    }
+
+    // Draw the map onto the image in false colour, on a log scale from low to high nanoseconds; by default, the range
+    // of the map itself.
+    void paint(Framebuffer& image) const {
+        float low, high;
+        range(low, high);
+        paint(image, low, high);
+    }
+
+    void paint(Framebuffer& image, float low, float high) const {
+        float spread = std::log(std::max(high / low, 1.0001f));
+        for (int y = 0; y < std::min(height, (int) image.height); y++) {
+            uint32_t* row = image.row(y);
+            for (int x = 0; x < std::min(width, (int) image.width); x++) {
+                float cost = at(x, y);
+                row[x] = falseColor(cost <= low ? 0 : std::log(cost / low) / spread);
+            }
+        }
+    }
+
+    // The packed colour of a cost from 0 (cheapest) to 1 (most expensive).
+    static uint32_t falseColor(float t) {
+        static const Color stops[] = { { 0, 0, 0 }, { 0.35, 0, 0.55 }, { 0.9, 0.1, 0.1 }, { 1, 0.8, 0 }, { 1, 1, 1 } };
+        constexpr int last = sizeof(stops) / sizeof(stops[0]) - 1;
+
+        float at = std::clamp(t, 0.0f, 1.0f) * last;
+        int below = std::min((int) at, last - 1);
+        Scalar blend = at - (float) below;
+        Color c = stops[below] * (1 - blend) + stops[below + 1] * blend;
+        return c.pack();
+    }
+
+private:
+    int width;
+    int height;
+    // Nanoseconds per pixel, row by row.
+    std::unique_ptr<std::atomic<float>[]> costs;
+};
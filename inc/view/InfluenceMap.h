@@ -0,0 +1,129 @@
+/***************
+ * THECURLE    *
+ *     BOUNCER *
+ ***************/
+
+#include <render/Influence.h>
+#include <render/Light.h>
+#include <render/Scheduler.h>
+#include <view/Camera.h>
+#include <cmath>
+#include <vector>
+
+#pragma once
+
+/**
+ * An influence record for every tile of the image, and the rules for which tiles an edit to the world invalidates.
+ *
+ * A tile is only trusted once it's been rendered through to full resolution with recording on. Anything else (never
+ * rendered, abandoned partway, or invalidated by an edit) is dirty, and is traced again by the next frame.
+ *
+ * Edits are judged conservatively, so that a tile is never left showing the world as it was:
+ *  - a change to an object's material dirties the tiles whose rays touched it;
+ *  - a change to the light dirties every tile that shaded anything;
+ *  - moving an object also dirties the tiles it covers on screen before and after the move, the tiles whose shadow rays
+ *    could pass through it before or after, and every tile that traced a reflection or refraction.
+ */
+class InfluenceMap {
+public:
+    InfluenceMap(int width, int height, int tileSize = TileScheduler::defaultTileSize)
+        : width(width), height(height), tileSize(tileSize),
+          columns((width + tileSize - 1) / tileSize), rows((height + tileSize - 1) / tileSize),
+          order(TileScheduler::tile(0, 0, width, height, tileSize)), records((size_t) columns * rows) { }
+
+    TileInfluence& at(const Tile& tile) {
+        return records[index(tile)];
+    }
+
+    void invalidateAll() {
+        for (TileInfluence& record : records)
+            record.valid = false;
+    }
+
+    // The tiles that have to be traced again, in the same order that the scheduler would render them in.
+    [[nodiscard]] std::vector<Tile> dirty() const {
+        std::vector<Tile> out;
+        for (const Tile& tile : order)
+            if (!records[index(tile)].valid) out.emplace_back(tile);
+        return out;
+    }
+
+    // Something about the object other than its position changed, such as its material.
+    void objectChanged(const Geo* object) {
+        for (TileInfluence& record : records)
+            if (record.touches(object)) record.valid = false;
+    }
+
+    // The object moved, and now lies in the after bounds rather than the before.
+    void objectMoved(const Geo* object, const Bounds& before, const Bounds& after, const Camera& cam, const PointLight& light) {
+        Tile screenBefore = onScreen(before, cam);
+        Tile screenAfter = onScreen(after, cam);
+
+        for (const Tile& tile : order) {
+            TileInfluence& record = records[index(tile)];
+            if (!record.valid) continue;
+
+            record.valid = !(record.touches(object) || record.secondary
+                    || overlaps(tile, screenBefore) || overlaps(tile, screenAfter)
+                    || shadowsCross(record, light, before) || shadowsCross(record, light, after));
+        }
+    }
+
+    // The light moved, or changed color.
+    void lightChanged() {
+        for (TileInfluence& record : records)
+            if (!record.objects.empty()) record.valid = false;
+    }
+
+    // The rectangle of pixels that the bounds could cover on screen.
+    // Bounds that are unbounded, or that reach behind the camera, could cover anything.
+    [[nodiscard]] Tile onScreen(const Bounds& b, const Camera& cam) const {
+        if (b.isEmpty()) return { 0, 0, 0, 0 };
+        if (b.isInfinite()) return { 0, 0, width, height };
+
+        Scalar minX = std::numeric_limits<Scalar>::infinity(), minY = minX;
+        Scalar maxX = -minX, maxY = -minX;
+        for (int corner = 0; corner < 8; corner++) {
+            Point p { corner & 1 ? b.max[0] : b.min[0], corner & 2 ? b.max[1] : b.min[1], corner & 4 ? b.max[2] : b.min[2] };
+            Scalar x, y;
+            if (!cam.project(p, x, y)) return { 0, 0, width, height };
+
+            minX = std::min(minX, x); maxX = std::max(maxX, x);
+            minY = std::min(minY, y); maxY = std::max(maxY, y);
+        }
+
+        // A pixel is covered if any part of it is; pad by one for the rounding of the projection.
+        return { clamp((int) std::floor(minX) - 1, width), clamp((int) std::floor(minY) - 1, height),
+                 clamp((int) std::ceil(maxX) + 2, width), clamp((int) std::ceil(maxY) + 2, height) };
+    }
+
+private:
+    int width, height, tileSize;
+    int columns, rows;
+    // Every tile, in the scheduler's order.
+    std::vector<Tile> order;
+    // One record per tile, row by row.
+    std::vector<TileInfluence> records;
+
+    [[nodiscard]] size_t index(const Tile& tile) const {
+        return (size_t) (tile.fromY / tileSize) * columns + (tile.fromX / tileSize);
+    }
+
+    static int clamp(int v, int max) {
+        return std::max(0, std::min(v, max));
+    }
+
+    static bool overlaps(const Tile& a, const Tile& b) {
+        return a.fromX < b.toX && b.fromX < a.toX && a.fromY < b.toY && b.fromY < a.toY;
+    }
+
+    // Whether a shadow ray from the tile could pass through the bounds.
+    // Every shadow ray lies between the tile's shaded points and the light, so it's inside the box around both.
+    static bool shadowsCross(const TileInfluence& record, const PointLight& light, const Bounds& b) {
+        if (record.points.isEmpty()) return false;
+
+        Bounds rays = record.points;
+        rays.extend(light.position.x, light.position.y, light.position.z);
+        return rays.overlaps(b);
+    }
+};
@@ -0,0 +1,118 @@
+/***************
+ * THECURLE    *
+ *     BOUNCER *
+ ***************/
+
+#include <core/Raster.hpp>
+#include <render/Geometry.h>
+#include <render/Scheduler.h>
+#include <view/Camera.h>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#pragma once
+
+/**
+ * The primary hit behind every pixel of the last frame, so that a new frame from a slightly different camera can reuse them.
+ *
+ * A pixel's sample is only kept if the color on screen is the exact shading of that one point, and the shading doesn't
+ * depend on where it's seen from. Reflective and transparent hits are never kept, and neither are the pixels of a coarse
+ * level, which show a neighbour's color. The one exception is specular highlights, which are reused as they are; they
+ * slide a little during a camera move, and the full render after the move puts them right.
+ *
+ * reproject moves every kept sample to where the new camera sees it, nearest first. Whatever pixels are left uncovered
+ * (newly seen surfaces, the edges of the screen, cracks where the view magnified) are marked to be traced.
+ */
+class Reprojection {
+public:
+    Reprojection(int width, int height)
+        : width(width), height(height), samples((size_t) width * height), needed((size_t) width * height, 1) { }
+
+    // Whether the pixel has to be traced for the current frame.
+    [[nodiscard]] bool needsTrace(int x, int y) const {
+        return needed[index(x, y)] != 0;
+    }
+
+    // Whether any pixel of the tile has to be traced.
+    [[nodiscard]] bool needsTrace(const Tile& tile) const {
+        for (int y = tile.fromY; y < tile.toY; y++)
+            for (int x = tile.fromX; x < tile.toX; x++)
+                if (needed[index(x, y)]) return true;
+        return false;
+    }
+
+    // Trace every pixel of the tile in the current frame, and forget what was there; it's out of date.
+    void traceAll(const Tile& tile) {
+        for (int y = tile.fromY; y < tile.toY; y++) {
+            for (int x = tile.fromX; x < tile.toX; x++) {
+                needed[index(x, y)] = 1;
+                samples[index(x, y)].kept = false;
+            }
+        }
+    }
+
+    // Note down the primary hit behind a freshly traced pixel.
+    void record(int x, int y, const RT::Intersection& hit, const RT::Ray& r) {
+        Sample& s = samples[index(x, y)];
+        s.kept = !hit.isEmpty() && hit.object->material.reflectivity == 0 && hit.object->material.transparency == 0;
+        if (s.kept) s.point = RT::Ray::position(r, hit.time);
+    }
+
+    // The pixel shows a color that isn't its own, so there's nothing to reuse.
+    void forget(int x, int y) {
+        samples[index(x, y)].kept = false;
+    }
+
+    // Move the last frame onto the canvas as the given camera would see it, and work out what's left to trace.
+    void reproject(const Camera& to, Framebuffer& canvas) {
+        std::vector<Sample> moved(samples.size());
+        std::vector<Scalar> depth(samples.size(), std::numeric_limits<Scalar>::infinity());
+        std::vector<uint32_t> colors(samples.size());
+
+        for (int y = 0; y < height; y++) {
+            for (int x = 0; x < width; x++) {
+                const Sample& s = samples[index(x, y)];
+                if (!s.kept) continue;
+
+                Scalar toX, toY, distance;
+                if (!to.project(s.point, toX, toY, &distance)) continue;
+
+                int nx = (int) std::lround(toX), ny = (int) std::lround(toY);
+                if (nx < 0 || ny < 0 || nx >= width || ny >= height) continue;
+
+                // Where two samples land on the same pixel, the nearer one hides the other.
+                size_t dest = index(nx, ny);
+                if (distance >= depth[dest]) continue;
+                depth[dest] = distance;
+                moved[dest] = s;
+                colors[dest] = canvas.at(x, y);
+            }
+        }
+
+        for (int y = 0; y < height; y++) {
+            for (int x = 0; x < width; x++) {
+                size_t i = index(x, y);
+                needed[i] = !moved[i].kept;
+                if (moved[i].kept) canvas.set(x, y, colors[i]);
+            }
+        }
+
+        samples = std::move(moved);
+    }
+
+private:
+    struct Sample {
+        Point point { 0, 0, 0 };
+        bool kept = false;
+    };
+
+    int width, height;
+    std::vector<Sample> samples;
+    // One per pixel; non-zero if the pixel has to be traced.
+    std::vector<uint8_t> needed;
+
+    [[nodiscard]] size_t index(int x, int y) const {
+        return (size_t) y * width + x;
+    }
+};
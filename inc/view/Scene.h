@@ -0,0 +1,156 @@
+/***************
+ * THECURLE    *
+ *     BOUNCER *
+ ***************/
+
+#include <view/World.h>
+#include <view/Camera.h>
+#include <render/Patterns.h>
+#include <chrono>
+#include <istream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#pragma once
+
+// How long loading a scene took, split into reading the file and building the world from it.
+struct SceneLoadStats {
+    std::chrono::nanoseconds parse { 0 };
+    std::chrono::nanoseconds build { 0 };
+    size_t objects = 0;
+    // Whether the scene came from its binary cache rather than the text.
+    bool cached = false;
+};
+
+/**
+ * A world to render, and where to view it from.
+ * The camera is only described, rather than built, so that the same scene can be rendered at any resolution.
+ *
+ * Scenes can be loaded from a text file of one statement per line. # starts a comment, and angles are in degrees.
+ *
+ *   camera from 0 0 -5 to 0 0 0 up 0 1 0 fov 60
+ *   light position -10 10 -10 intensity 1 1 1
+ *   pattern tiles checker a 1 1 1 b 0 0 0 scale 0.5 0.5 0.5
+ *   material floor pattern tiles specular 0 reflectivity 0.2
+ *   plane material floor translate 0 -1 0
+ *   sphere color 1 0 0 scale 0.5 0.5 0.5 rotate-y 45 translate 0 1 0
+ *
+ * Patterns are stripe, checker or debug, with colors a and b. Materials take color, pattern, ambient, diffuse, specular,
+ * shininess, reflectivity, transparency and refractiveIndex. An object starts from the named material if given, then
+ * takes any material settings of its own. Transforms (translate, scale, rotate-x, rotate-y, rotate-z, and shear with
+ * six factors) are applied in the order they're written.
+ */
+struct Scene {
+    World world;
+    Point from { 0, 0, -5 };
+    Point to { 0, 0, 0 };
+    Vector up { 0, 1, 0 };
+    Scalar fieldOfView = M_PI / 3;
+
+    // Objects of one kind, in blocks that never move once they're allocated, so the world can point into them.
+    template <typename T>
+    struct Blocks {
+        static constexpr size_t blockSize = 4096;
+        std::vector<std::vector<T>> blocks;
+
+        T& add() {
+            if (blocks.empty() || blocks.back().size() == blockSize) {
+                blocks.emplace_back();
+                blocks.back().reserve(blockSize);
+            }
+            return blocks.back().emplace_back();
+        }
+    };
+
+    // The objects and patterns of a loaded scene live here; the world only points at them.
+    struct Storage {
+        Blocks<Sphere> spheres;
+        Blocks<Plane> planes;
+        std::vector<std::shared_ptr<Pattern::Pattern>> patterns;
+    } owned;
+
+    // A camera looking at the scene, rendering an image of the given size.
+    [[nodiscard]] Camera camera(int width, int height) const {
+        Camera cam(width, height, fieldOfView);
+        cam.setTransform(from, to, up);
+        return cam;
+    }
+
+    // The scenes that are built in, by name; the two hand made ones, then the benchmark corpus.
+    static std::vector<std::string> builtins() {
+        std::vector<std::string> names { "spheres", "default" };
+        for (const std::string& name : corpus())
+            names.push_back(name);
+        return names;
+    }
+
+    // Build the named built-in scene. Returns false if there's no scene by that name.
+    static bool builtin(const std::string& name, Scene& out) {
+        if (name == "spheres") {
+            out = spheres();
+            return true;
+        }
+        if (name == "default") {
+            out = Scene();
+            out.world = World::defaultWorld();
+            return true;
+        }
+        return corpusScene(name, out);
+    }
+
+    // The scenes that renders are benchmarked on, by name. Each stresses one part of the renderer:
+    //  - diffuse-spheres: a field of matte spheres on a floor; primary rays, shading and shadows;
+    //  - mirrors: a hall of facing mirrors; reflection all the way down to the recursion limit;
+    //  - nested-glass: glass spheres inside each other; refraction, and the intersection lists it needs;
+    //  - checker-planes: patterned planes; unbounded objects, and patterns;
+    //  - sweep-10 up to sweep-1000000: that many small spheres scattered through a cube; how the BVH scales.
+    static std::vector<std::string> corpus();
+
+    // Build the named corpus scene. They're generated from a fixed seed, so they're the same on every machine.
+    static bool corpusScene(const std::string& name, Scene& out);
+
+    // Load a scene from text, as described above. On failure, returns false and says which line was wrong in error.
+    static bool load(std::istream& in, Scene& out, std::string& error, SceneLoadStats* stats = nullptr);
+
+    // Load a scene from a file, as with load.
+    static bool loadFile(const std::string& path, Scene& out, std::string& error, SceneLoadStats* stats = nullptr);
+
+    // Load a scene file through its binary cache, which is kept next to it.
+    // If the cache is missing or stale, the text is loaded instead and a new cache written for next time.
+    static bool loadFileCached(const std::string& path, Scene& out, std::string& error, SceneLoadStats* stats = nullptr);
+
+    // Where the binary cache of a scene file is kept.
+    static std::string cachePath(const std::string& path) {
+        return path + ".cache";
+    }
+
+    // Write the scene, with its acceleration structure, to a binary cache of the given source file.
+    // Only spheres, planes and the built-in patterns can be cached.
+    static bool saveCache(const Scene& scene, const std::string& cache, const std::string& source, std::string& error);
+
+    // Map a binary cache and build the scene from it. Fails if the cache is from another version or build of the
+    // renderer, is damaged, or doesn't match the source file as it is now.
+    static bool loadCache(const std::string& cache, const std::string& source, Scene& out, std::string& error, SceneLoadStats* stats = nullptr);
+
+    // Four big spheres, seen from far away; what the live view opens on.
+    static Scene spheres() {
+        auto* one = new Sphere;
+        one->setMatrix(Mat4::scaling(100, 100, 100));
+        one->material.color = Color(1.0, 0, 0);
+        auto* two = new Sphere;
+        two->setMatrix(Mat4::translation(100, 0, 200) * Mat4::scaling(100, 100, 100));
+        auto* three = new Sphere;
+        three->setMatrix(Mat4::translation(-100, 0, -200) * Mat4::scaling(100, 100, 100));
+        auto* four = new Sphere;
+        four->setMatrix(Mat4::translation(200, 200, 200) * Mat4::scaling(100, 100, 100));
+
+        Scene scene;
+        scene.world = World(
+                { one, two, three, four },
+                { { -50, 100, -250 }, { 1, 1, 1 } }
+        );
+        scene.from = { 0, 0, -1500 };
+        return scene;
+    }
+};
@@ -6,10 +6,17 @@
 #include <catch2/catch_test_macros.hpp>
 #include <utility>
 #include <core/Matrix.h>
+#include <core/Trace.h>
 #include <render/Geometry.h>
 #include <render/Ray.h>
 #include <render/Light.h>
+#include <render/BVH.h>
+#include <render/Scheduler.h>
+#include <render/Influence.h>
+#include <render/RenderStats.h>
 #include <view/Camera.h>
+#include <view/Heatmap.h>
+#include <view/Reprojection.h>
 
 #pragma once
 
@@ -19,65 +26,152 @@ struct World {
     std::unique_ptr<Geo*[]> objects;
     size_t numObjs = 0;
     PointLight lightSource;
+    // The acceleration structure that intersect walks instead of testing every object.
+    BVH accel;
 
     World() : lightSource(PointLight({ 0, 0, 0 }, { 0, 0, 0 })) {}
 
     World(std::initializer_list<Geo*> geo, const PointLight& light) : objects(std::make_unique<Geo*[]>(geo.size())), numObjs(geo.size()), lightSource(light) {
         std::copy(geo.begin(), geo.end(), objects.get());
+        buildAccel();
     }
 
     void addObjects(std::initializer_list<Geo*> init) {
-        auto geos = std::make_unique<Geo*[]>(numObjs + init.size());
+        addObjects(init.begin(), init.size());
+    }
+
+    // Add any number of objects in one go; the object list is grown and the acceleration structure rebuilt only once.
+    void addObjects(Geo* const* geo, size_t count) {
+        auto geos = std::make_unique<Geo*[]>(numObjs + count);
         std::copy(objects.get(), objects.get() + numObjs, geos.get());
-        std::copy(init.begin(), init.end(), geos.get() + numObjs);
-        numObjs += init.size();
-        objects.release();
+        std::copy(geo, geo + count, geos.get() + numObjs);
+        numObjs += count;
         objects = std::move(geos);
+        buildAccel();
+    }
+
+    // Rebuild the acceleration structure over the current objects.
+    // Must be called whenever an object in the world is moved, or it may be missed by rays.
+    void buildAccel() {
+        accel.build(objects.get(), numObjs);
     }
 
     static World defaultWorld() {
         return World(
                 {
                     new Sphere(Material({ 0.8, 1.0, 0.6 }, 0.1, 0.7, 0.2, 200, 0, 0, 1)),
-                    new Sphere(Matrix::scaling(0.5, 0.5, 0.5))
+                    new Sphere(Mat4::scaling(0.5, 0.5, 0.5))
                 },
 
                 PointLight({ -10, 10, -10 }, { 1, 1, 1 } )
         );
     }
 
-    // Get a list of intersections that the given ray will have.
-    // Iterates every object in the world and checks whether the ray will intersect.
-    // TODO: this is a vicious hotspot, how can we remove the Vector from this?
+    // Get a sorted list of intersections that the given ray will have.
+    // Walks the BVH, so only objects whose bounds the ray passes through are checked.
     RT::Intersections intersect(RT::Ray& r) {
-        std::vector<RT::Intersection> isects;
-        isects.reserve(5);
+        RT::Intersections isects;
+        accel.intersect(r, isects);
+        isects.sort();
+        return isects;
+    }
 
-        for (size_t i = 0; i < numObjs; i++) {
-            objects[i]->intersect(r, isects);
-        }
+    // Get the nearest intersection inside the ray's interval, or an empty intersection if there is none.
+    // The ray's tMax is pulled in to the hit.
+    RT::Intersection closestHit(RT::Ray& r) {
+        return accel.closestHit(r);
+    }
 
-        return { isects.begin(), isects.end() };
+    // Whether anything in the world lies along the ray in [0, tMax).
+    // Returns on the first blocker found, so it's much cheaper than intersect when the order of hits doesn't matter.
+    bool occluded(RT::Ray& r, Scalar tMax) {
+        return accel.occluded(r, tMax);
     }
 
-    // Render this world using Ray Tracing, onto the given canvas.
-    void renderRT(const Camera& cam, Framebuffer& canvas, int fromX, int fromY, int toX, int toY, bool fast) {
-        auto startTime = std::chrono::system_clock::now();
+    // Render one tile of the image onto the given canvas.
+    // For progressive rendering, only the pixels on a grid of the given step are traced, and each is splatted over the
+    // step by step block below and to the right of it. Each level halves the step of the one before, so unless this is
+    // the coarsest level, the pixels on the grid of twice the step were already traced and are left alone.
+    // If an influence record is given, everything that goes into the tile is noted down in it.
+    // If a history is given, only the pixels it says need tracing are traced, and the hit behind each is stored in it.
+    // If a heatmap is given, how long each pixel took is recorded in it.
+    void renderTile(const Camera& cam, Framebuffer& canvas, const Tile& tile, bool fast, int step = 1, bool coarsest = true,
+                    TileInfluence* influence = nullptr, Reprojection* history = nullptr, Heatmap* costs = nullptr) {
+        TileInfluence*& recording = TileInfluence::recording();
+        TileInfluence* outer = recording;
+        recording = influence;
+
+        int firstX = (tile.fromX + step - 1) / step * step;
+        int firstY = (tile.fromY + step - 1) / step * step;
+
+        for (int y = firstY; y < tile.toY; y += step) {
+            bool reusedRow = !coarsest && y % (step * 2) == 0;
+            for (int x = firstX; x < tile.toX; x += step) {
+                if (reusedRow && x % (step * 2) == 0) continue;
+                if (history && !history->needsTrace(x, y)) continue;
 
-        #pragma omp target teams distribute parallel for default(none) shared(canvas, cam, fromX, fromY, toX, toY, fast)
-        for (int y = fromY; y < toY; y++) {
-            for (int x = fromX; x < toX; x++) {
+                Heatmap::Clock::time_point started = costs ? Heatmap::Clock::now() : Heatmap::Clock::time_point();
                 RT::Ray r = cam.rayForPixel(x, y);
-                Color pix = Light::at(*this, r, 10, fast);
-                canvas.set(x, y, pix);
+                RenderStats::count(RenderStats::PrimaryRays);
+                RT::Intersection primary;
+                Color pix = Light::at(*this, r, Light::maxBounces, fast, history ? &primary : nullptr);
+                if (step == 1)
+                    canvas.set(x, y, pix);
+                else
+                    canvas.fill(x, y, x + step, y + step, pix);
+                if (costs) costs->record(x, y, x + step, y + step, started);
+
+                if (history) {
+                    // The rest of the block shows this pixel's color rather than its own, and a preview's flat colors are no use to a full render.
+                    for (int by = y; by < std::min(y + step, (int) canvas.height); by++)
+                        for (int bx = x; bx < std::min(x + step, (int) canvas.width); bx++)
+                            history->forget(bx, by);
+                    if (!fast) history->record(x, y, primary, r);
+                }
             }
         }
 
+        recording = outer;
+    }
+
+    // Render this world using Ray Tracing, onto the given canvas.
+    // The region is split into tiles, which the threads share out between themselves as they go.
+    // The timing of the render is written to the given log; what went into it is counted and returned.
+    // If a heatmap is given, how long each pixel took is recorded in it.
+    RenderStats renderRT(const Camera& cam, Framebuffer& canvas, int fromX, int fromY, int toX, int toY, bool fast, std::ostream& log = std::cout,
+                         Heatmap* costs = nullptr) {
+        Trace::Scope trace("render");
+        auto startTime = std::chrono::system_clock::now();
+
+        TileScheduler scheduler(omp_get_max_threads());
+        std::vector<RenderStats> counted(scheduler.workerCount());
+        scheduler.run(TileScheduler::tile(fromX, fromY, toX, toY), [&](const Tile& tile) {
+            Trace::Scope traceTile("tile");
+            RenderStats*& recording = RenderStats::recording();
+            RenderStats* outer = recording;
+            recording = &counted[omp_get_thread_num()];
+            renderTile(cam, canvas, tile, fast, 1, true, nullptr, nullptr, costs);
+            recording = outer;
+        });
+
         // Some performance detail.
         auto endTime = std::chrono::system_clock::now();
-        std::cout << "RT Timing data:" << std::endl <<
+        log << "RT Timing data:" << std::endl <<
                 " Pixels rendered: " << cam.horizontalSize * cam.verticalSize << " (" << toX << "x" << toY << ")" << std::endl <<
                 " Average time per pixel: " << std::chrono::duration_cast<std::chrono::nanoseconds>(endTime - startTime).count() / (cam.horizontalSize * cam.verticalSize) << "ns" << std::endl <<
                 " Total render time: " << std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime).count() << "us (" << std::chrono::duration_cast<std::chrono::seconds>(endTime - startTime).count() << "s)" << std::endl;
+
+        std::vector<WorkerStats> threads = scheduler.stats();
+        for (size_t i = 0; i < threads.size(); i++) {
+            log << " Thread " << i << ": " << std::chrono::duration_cast<std::chrono::microseconds>(threads[i].busy).count() << "us busy, " <<
+                    std::chrono::duration_cast<std::chrono::microseconds>(threads[i].idle).count() << "us idle, " <<
+                    threads[i].tiles << " tiles (" << threads[i].stolen << " stolen)" << std::endl;
+        }
+
+        RenderStats total;
+        for (const RenderStats& thread : counted)
+            total += thread;
+        total.time = std::chrono::duration_cast<std::chrono::nanoseconds>(endTime - startTime);
+        return total;
     }
 };
@@ -0,0 +1,64 @@
+/***************
+ * THECURLE    *
+ *     BOUNCER *
+ ***************/
+
+#include <catch2/internal/catch_compiler_capabilities.hpp>
+#include <catch2/catch_reporter_registrars.hpp>
+#include <catch2/catch_test_case_info.hpp>
+#include <catch2/reporters/catch_reporter_streaming_base.hpp>
+#include <core/Json.h>
+#include <iomanip>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// A reporter that writes the results of every benchmark as one JSON document, so runs can be compared release to release.
+// Run the benchmarks with it as: bench -r json -o bench.json
+//
+// Every time is in nanoseconds per run of the benchmark body; the bounds are those of Catch's bootstrapped estimate.
+
+namespace {
+    class BenchJsonReporter : public Catch::StreamingReporterBase {
+    public:
+        using StreamingReporterBase::StreamingReporterBase;
+
+        static std::string getDescription() {
+            return "Reports benchmark results as a JSON document";
+        }
+
+        void benchmarkEnded(Catch::BenchmarkStats<> const& stats) override {
+            results.push_back({ currentTestCaseInfo ? currentTestCaseInfo->name : std::string(), stats.info.name,
+                                stats.info.samples, stats.info.iterations, stats.mean.point.count(), stats.mean.lower_bound.count(),
+                                stats.mean.upper_bound.count(), stats.standardDeviation.point.count(), stats.outlierVariance });
+        }
+
+        void testRunEnded(Catch::TestRunStats const& runStats) override {
+            stream << std::setprecision(6) << "{\n  \"benchmarks\": [";
+            for (size_t i = 0; i < results.size(); i++) {
+                const Result& r = results[i];
+                stream << (i ? ",\n" : "\n") << "    { \"group\": " << jsonString(r.group) << ", \"name\": " << jsonString(r.name) <<
+                        ", \"samples\": " << r.samples << ", \"iterations\": " << r.iterations <<
+                        ", \"mean_ns\": " << r.mean << ", \"mean_low_ns\": " << r.low << ", \"mean_high_ns\": " << r.high <<
+                        ", \"stddev_ns\": " << r.deviation << ", \"outlier_variance\": " << r.outlierVariance << " }";
+            }
+            stream << "\n  ]\n}" << std::endl;
+            StreamingReporterBase::testRunEnded(runStats);
+        }
+
+    private:
+        struct Result {
+            std::string group;
+            std::string name;
+            int samples;
+            int iterations;
+            double mean, low, high;
+            double deviation;
+            double outlierVariance;
+        };
+
+        std::vector<Result> results;
+    };
+}
+
+CATCH_REGISTER_REPORTER("json", BenchJsonReporter)
@@ -0,0 +1,218 @@
+/***************
+ * THECURLE    *
+ *     BOUNCER *
+ ***************/
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <render/Geometry.h>
+#include <render/Light.h>
+#include <view/World.h>
+
+using namespace RT;
+
+// Compare two doubles with tolerance.
+bool safeCompare(double a, double b) {
+    return std::abs(a - b) < 0.001;
+}
+
+TEST_CASE("Tuple arithmetic", "[bench][tuple]") {
+    Vector a { 1, 2, 3 };
+    Vector b { -4, 0.5, 2 };
+    Color c { 0.2, 0.4, 0.6 };
+
+    BENCHMARK("Vector::cross") {
+        return a.cross(b);
+    };
+
+    BENCHMARK("Vector::normalize") {
+        return a.normalize();
+    };
+
+    BENCHMARK("Vector::reflect") {
+        return a.reflect(b);
+    };
+
+    BENCHMARK("Color * Color") {
+        return c * Color(0.9, 0.8, 0.7);
+    };
+}
+
+TEST_CASE("Sphere intersection", "[bench][geometry]") {
+    Sphere s;
+    s.setMatrix(Matrix::translation(0.5, 0, 0) * Matrix::scaling(2, 2, 2));
+    Ray hit { { 0, 0, -5 }, { 0, 0, 1 } };
+    Ray miss { { 0, 5, -5 }, { 0, 0, 1 } };
+
+    Intersections out;
+
+    BENCHMARK("Sphere::intersect (hit)") {
+        out.clear();
+        s.intersect(hit, out);
+        return out.size;
+    };
+
+    BENCHMARK("Sphere::intersect (miss)") {
+        out.clear();
+        s.intersect(miss, out);
+        return out.size;
+    };
+}
+
+TEST_CASE("Plane intersection", "[bench][geometry]") {
+    Plane p;
+    p.setMatrix(Matrix::translation(0, -1, 0));
+    Ray hit { { 0, 1, -5 }, { 0, -0.5, 1 } };
+    Ray parallel { { 0, 1, -5 }, { 0, 0, 1 } };
+
+    Intersections out;
+
+    BENCHMARK("Plane::intersect (hit)") {
+        out.clear();
+        p.intersect(hit, out);
+        return out.size;
+    };
+
+    BENCHMARK("Plane::intersect (parallel)") {
+        out.clear();
+        p.intersect(parallel, out);
+        return out.size;
+    };
+}
+
+TEST_CASE("World intersection", "[bench][world]") {
+    // A square grid of small spheres in front of the camera, with a ray straight down the middle.
+    for (int side : { 1, 4, 16, 64 }) {
+        World w;
+        std::vector<Geo*> spheres;
+        for (int y = 0; y < side; y++) {
+            for (int x = 0; x < side; x++) {
+                auto* s = new Sphere;
+                s->setMatrix(Matrix::translation(x * 3 - side * 1.5, y * 3 - side * 1.5, 0));
+                spheres.push_back(s);
+            }
+        }
+        w.addObjects(spheres.data(), spheres.size());
+
+        Ray r { { -side * 1.5, -side * 1.5, -10 }, { 0, 0, 1 } };
+        std::string count = std::to_string(side * side);
+
+        BENCHMARK("World::intersect, " + count + " spheres") {
+            return w.intersect(r).size;
+        };
+
+        BENCHMARK("World::closestHit, " + count + " spheres") {
+            Ray copy = r;
+            return w.closestHit(copy).time;
+        };
+    }
+}
+
+TEST_CASE("Matrix inversion", "[bench][matrix]") {
+    Mat4 affine = Matrix::translation(1, 2, 3) * Matrix::rotation_y(0.5) * Matrix::scaling(2, 3, 4);
+    Mat4 projective = affine;
+    projective.data[12] = 0.25;
+    Matrix general = affine;
+
+    BENCHMARK("Matrix::fastInverse") {
+        return Matrix::fastInverse(general);
+    };
+
+    BENCHMARK("Matrix::inverse") {
+        return Matrix::inverse(general);
+    };
+
+    BENCHMARK("Mat4::affineInverse") {
+        return Mat4::affineInverse(affine);
+    };
+
+    BENCHMARK("Mat4::generalInverse") {
+        return Mat4::generalInverse(projective);
+    };
+}
+
+TEST_CASE("Camera rays", "[bench][camera]") {
+    Camera c(800, 600, M_PI / 3);
+    c.setTransform({ 0, 0, -5 }, { 0, 0, 0 }, { 0, 1, 0 });
+
+    // Walk along a row, so that the compiler can't work the ray out ahead of time.
+    int x = 0;
+    BENCHMARK("Camera::rayForPixel") {
+        x = (x + 1) % 800;
+        return c.rayForPixel(x, 300);
+    };
+}
+
+TEST_CASE("Color packing", "[bench][raster]") {
+    Color c { 0.2, 0.4, 0.6 };
+
+    BENCHMARK("Color::pack") {
+        return c.pack();
+    };
+}
+
+TEST_CASE("Phong lighting", "[bench][lighting]") {
+    Material m;
+    Sphere s(m);
+    PointLight light { { -10, 10, -10 }, { 1, 1, 1 } };
+    Point position { 0, 0, -1 };
+    Vector eyev { 0, 0, -1 };
+    Vector normalv { 0, 0, -1 };
+
+    BENCHMARK("Light::lighting (lit)") {
+        return Light::lighting(m, &s, light, position, eyev, normalv, false);
+    };
+
+    BENCHMARK("Light::lighting (shadowed)") {
+        return Light::lighting(m, &s, light, position, eyev, normalv, true);
+    };
+}
+
+TEST_CASE("Intersection detail through stacked glass", "[bench][refraction]") {
+    Ray r { { 0, 0, -40 }, { 0, 0, 1 } };
+
+    for (size_t depth : { 1, 4, 16, 32 }) {
+        std::vector<Sphere> spheres(depth);
+        for (size_t i = 0; i < depth; i++) {
+            spheres[i].material.transparency = 1;
+            spheres[i].material.refractiveIndex = 1.5;
+            Scalar radius = 32 - (Scalar) i;
+            spheres[i].setMatrix(Matrix::scaling(radius, radius, radius));
+        }
+
+        Intersections xs;
+        for (Sphere& s : spheres)
+            s.intersect(r, xs);
+        xs.sort();
+
+        // The entry into the innermost sphere; the deepest point of the stack.
+        Intersection deepest = xs[depth - 1];
+        BENCHMARK("fillDetail, " + std::to_string(depth) + " nested glass spheres") {
+            return Intersection::fillDetail(deepest, r, xs).refractiveIdxOutgoing;
+        };
+    }
+
+    Sphere opaque;
+    Intersections single { { 39, &opaque } };
+    BENCHMARK("fillDetail, opaque sphere") {
+        return Intersection::fillDetail(single[0], r, single).refractiveIdxOutgoing;
+    };
+
+    BENCHMARK("fillDetail, opaque sphere, shading only") {
+        return Intersection::fillDetail(single[0], r, single, single[0].detailNeeds()).overPoint.z;
+    };
+}
+
+TEST_CASE("Tracing", "[bench][trace]") {
+    Trace::Recorder& recorder = Trace::Recorder::get();
+
+    BENCHMARK("Trace::Scope (off)") {
+        Trace::Scope trace("bench");
+    };
+
+    recorder.start();
+    BENCHMARK("Trace::Scope (on)") {
+        Trace::Scope trace("bench");
+    };
+    recorder.stop();
+}
@@ -0,0 +1,275 @@
+/***************
+ * THECURLE    *
+ *     BOUNCER *
+ ***************/
+
+#include <core/Json.h>
+#include <core/Raster.hpp>
+#include <view/Scene.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <omp.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+// Renders the benchmark corpus (see Scene::corpus) end to end through World::renderRT, at a fixed size and on each of a
+// list of thread counts, and writes the results as one JSON document.
+//
+// Each scene is rendered at the given size on every thread count (strong scaling), and again with the image made that
+// many times taller (weak scaling: the same work per thread). The best of a few repeats is kept. Every image of the
+// strong runs is checksummed, and they must all agree; a render that depends on how it was split up is a bug.
+//
+// Rays per second counts every ray of the render; camera, shadow, reflected and refracted. What the rays were, and how
+// many intersection tests they took, is listed from the single thread render of each scene.
+
+namespace {
+    struct Options {
+        std::vector<std::string> scenes;
+        std::vector<int> threads;
+        std::string output;
+        int width = 320;
+        int height = 240;
+        int repeat = 3;
+        bool fast = false;
+    };
+
+    void usage() {
+        std::cerr << "Usage: bench-render [options]" << std::endl <<
+                "  --scene NAME     A scene to render; may be given more than once (default the whole corpus):";
+        for (const std::string& name : Scene::corpus())
+            std::cerr << " " << name;
+        std::cerr << std::endl <<
+                "  --width N        Width of the image in pixels (default 320)" << std::endl <<
+                "  --height N       Height of the image in pixels (default 240)" << std::endl <<
+                "  --threads A,B,.. The thread counts to render on (default 1, and doubling up to all cores)" << std::endl <<
+                "  --repeat N       Render each this many times and keep the fastest (default 3)" << std::endl <<
+                "  --fast           Flat colors only, as the live view's preview" << std::endl <<
+                "  --output FILE    Write the JSON here rather than to stdout" << std::endl;
+    }
+
+    // Read the command line into options. Returns false if it couldn't be understood.
+    bool parse(int argc, char* argv[], Options& options) {
+        for (int i = 1; i < argc; i++) {
+            std::string arg = argv[i];
+            bool hasValue = i + 1 < argc;
+
+            if (arg == "--fast") {
+                options.fast = true;
+            } else if (arg == "--scene" && hasValue) {
+                options.scenes.emplace_back(argv[++i]);
+            } else if (arg == "--output" && hasValue) {
+                options.output = argv[++i];
+            } else if (arg == "--width" && hasValue) {
+                options.width = std::atoi(argv[++i]);
+            } else if (arg == "--height" && hasValue) {
+                options.height = std::atoi(argv[++i]);
+            } else if (arg == "--repeat" && hasValue) {
+                options.repeat = std::atoi(argv[++i]);
+            } else if (arg == "--threads" && hasValue) {
+                std::stringstream list(argv[++i]);
+                std::string count;
+                while (std::getline(list, count, ','))
+                    options.threads.push_back(std::atoi(count.c_str()));
+            } else {
+                std::cerr << "Unknown or incomplete option " << arg << std::endl;
+                return false;
+            }
+        }
+
+        if (options.scenes.empty()) options.scenes = Scene::corpus();
+        if (options.threads.empty()) {
+            for (int t = 1; t < omp_get_num_procs(); t *= 2)
+                options.threads.push_back(t);
+            options.threads.push_back(omp_get_num_procs());
+        }
+
+        if (options.width <= 0 || options.height <= 0 || options.repeat <= 0) {
+            std::cerr << "The image size and repeat count must be positive." << std::endl;
+            return false;
+        }
+        for (int t : options.threads) {
+            if (t <= 0) {
+                std::cerr << "Thread counts must be positive." << std::endl;
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // FNV-1a over every pixel; the same image always gives the same sum.
+    std::string checksum(Framebuffer& canvas) {
+        uint64_t hash = 0xCBF29CE484222325ull;
+        for (size_t y = 0; y < canvas.height; y++) {
+            const auto* bytes = (const unsigned char*) canvas.row(y);
+            for (size_t i = 0; i < canvas.width * sizeof(uint32_t); i++) {
+                hash ^= bytes[i];
+                hash *= 0x100000001B3ull;
+            }
+        }
+
+        std::stringstream hex;
+        hex << std::hex << std::setw(16) << std::setfill('0') << hash;
+        return hex.str();
+    }
+
+    // The most memory the process has held at once, in kilobytes. It only ever goes up, so a scene's figure includes
+    // whatever the scenes before it needed.
+    long long peakResidentKb() {
+#ifdef _WIN32
+        PROCESS_MEMORY_COUNTERS counters;
+        if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return 0;
+        return (long long) (counters.PeakWorkingSetSize / 1024);
+#else
+        rusage usage {};
+        getrusage(RUSAGE_SELF, &usage);
+        return usage.ru_maxrss;
+#endif
+    }
+
+    struct Render {
+        std::chrono::nanoseconds time { 0 };
+        std::string checksum;
+        RenderStats stats;
+    };
+
+    // Render the scene at the given size on the given number of threads, keeping the fastest of the repeats.
+    Render render(Scene& scene, int width, int height, int threads, const Options& options) {
+        // renderRT reports its own timing; it isn't wanted here.
+        std::ostream quiet(nullptr);
+        omp_set_num_threads(threads);
+
+        Camera cam = scene.camera(width, height);
+        Framebuffer canvas(width, height);
+        Render best;
+        best.time = std::chrono::nanoseconds::max();
+        for (int i = 0; i < options.repeat; i++) {
+            auto start = std::chrono::steady_clock::now();
+            best.stats = scene.world.renderRT(cam, canvas, 0, 0, width, height, options.fast, quiet);
+            best.time = std::min(best.time, std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start));
+        }
+        best.checksum = checksum(canvas);
+        return best;
+    }
+
+    long long microseconds(std::chrono::nanoseconds d) {
+        return std::chrono::duration_cast<std::chrono::microseconds>(d).count();
+    }
+
+    template <typename T>
+    void list(std::ostream& out, const T* values, size_t count) {
+        out << "[";
+        for (size_t i = 0; i < count; i++)
+            out << (i ? ", " : "") << values[i];
+        out << "]";
+    }
+
+    void counts(std::ostream& out, const RenderStats& stats) {
+        out << "{ \"primary_rays\": " << stats[RenderStats::PrimaryRays] << ", \"shadow_rays\": " << stats[RenderStats::ShadowRays] <<
+                ", \"reflection_rays\": " << stats[RenderStats::ReflectionRays] << ", \"refraction_rays\": " << stats[RenderStats::RefractionRays] <<
+                ", \"sphere_tests\": " << stats[RenderStats::SphereTests] << ", \"plane_tests\": " << stats[RenderStats::PlaneTests] <<
+                ", \"detail_fills\": " << stats[RenderStats::DetailFills] << ", \"depths\": ";
+        list(out, stats.depths, RenderStats::depthBuckets);
+        out << ", \"media\": ";
+        list(out, stats.media, RenderStats::mediaBuckets);
+        out << ", \"deepest_media\": " << stats.deepestMedia << " }";
+    }
+}
+
+int main(int argc, char* argv[]) {
+    Options options;
+    if (!parse(argc, argv, options)) {
+        usage();
+        return 2;
+    }
+
+    std::stringstream json;
+    json << std::setprecision(6) << "{\n  \"width\": " << options.width << ", \"height\": " << options.height <<
+            ", \"repeat\": " << options.repeat << ", \"fast\": " << (options.fast ? "true" : "false") <<
+            ", \"scalar_bytes\": " << sizeof(Scalar) << ", \"cores\": " << omp_get_num_procs() << ",\n  \"scenes\": [";
+
+    bool allAgree = true;
+    for (size_t s = 0; s < options.scenes.size(); s++) {
+        const std::string& name = options.scenes[s];
+        std::cerr << name << std::endl;
+
+        auto buildStart = std::chrono::steady_clock::now();
+        Scene scene;
+        if (!Scene::builtin(name, scene)) {
+            std::cerr << "There's no scene called " << name << "." << std::endl;
+            return 1;
+        }
+        auto built = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - buildStart);
+
+        json << (s ? ",\n" : "\n") << "    { \"name\": " << jsonString(name) << ", \"objects\": " << scene.world.numObjs <<
+                ", \"build_us\": " << microseconds(built) << ",\n      \"runs\": [";
+
+        double pixels = (double) options.width * options.height;
+        std::chrono::nanoseconds single { 0 };
+        std::string firstChecksum;
+        RenderStats work;
+        bool agree = true;
+        for (size_t i = 0; i < options.threads.size(); i++) {
+            int threads = options.threads[i];
+            Render strong = render(scene, options.width, options.height, threads, options);
+            Render weak = threads == 1 ? strong : render(scene, options.width, options.height * threads, threads, options);
+
+            // Scaling is measured against the single thread render. If 1 isn't on the list, the first count stands in for it,
+            // as though it had scaled perfectly that far.
+            if (i == 0) {
+                single = strong.time * options.threads[0];
+                firstChecksum = strong.checksum;
+                work = strong.stats;
+            }
+            agree = agree && strong.checksum == firstChecksum;
+
+            double seconds = (double) strong.time.count() / 1e9;
+            double speedup = (double) single.count() / (double) strong.time.count();
+            double weakEfficiency = (double) single.count() / (double) weak.time.count();
+
+            json << (i ? ",\n" : "\n") << "        { \"threads\": " << threads << ", \"render_us\": " << microseconds(strong.time) <<
+                    ", \"ns_per_pixel\": " << (double) strong.time.count() / pixels <<
+                    ", \"mrays_per_s\": " << (double) strong.stats.rays() / seconds / 1e6 <<
+                    ", \"speedup\": " << speedup << ", \"efficiency\": " << speedup / threads <<
+                    ", \"weak_height\": " << options.height * threads << ", \"weak_render_us\": " << microseconds(weak.time) <<
+                    ", \"weak_efficiency\": " << weakEfficiency << ", \"checksum\": " << jsonString(strong.checksum) << " }";
+        }
+
+        if (!agree) std::cerr << name << " rendered differently on different thread counts." << std::endl;
+        allAgree = allAgree && agree;
+        json << "\n      ],\n      \"counts\": ";
+        counts(json, work);
+        json << ",\n      \"checksums_agree\": " << (agree ? "true" : "false") <<
+                ", \"peak_rss_kb\": " << peakResidentKb() << " }";
+    }
+    json << "\n  ],\n  \"checksums_agree\": " << (allAgree ? "true" : "false") << "\n}" << std::endl;
+
+    if (options.output.empty()) {
+        std::cout << json.str();
+    } else {
+        std::ofstream out(options.output);
+        out << json.str();
+        if (!out) {
+            std::cerr << "Couldn't write " << options.output << std::endl;
+            return 1;
+        }
+    }
+    return allAgree ? 0 : 1;
+}
+
+// Compare two doubles with tolerance.
+bool safeCompare(double a, double b) {
+    return std::abs(a - b) < 0.001;
+}
@@ -11,4 +11,7 @@ std::ostream& operator<<(std::ostream& stream, const Matrix& matrix) {
     }
 
     return stream;
-}
\ No newline at end of file
+}
+std::ostream& operator<<(std::ostream& stream, const Mat4& matrix) {
+    return stream << Matrix(matrix);
+}
@@ -0,0 +1,163 @@
+/***************
+ * THECURLE    *
+ *     BOUNCER *
+ ***************/
+
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include <core/Json.h>
+#include <core/Raster.hpp>
+#include <view/Scene.h>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <omp.h>
+
+// Renders a scene to an image file without opening a window, for render nodes and scripts.
+// The render's timing is written to stdout as a single line of JSON; everything else goes to stderr.
+
+namespace {
+    struct Options {
+        std::string scene = "spheres";
+        std::string output = "render.png";
+        std::string heatmap;
+        std::string trace;
+        int width = 800;
+        int height = 600;
+        int threads = 0;
+        bool fast = false;
+        bool cache = true;
+    };
+
+    void usage() {
+        std::cerr << "Usage: bouncer-batch [options]" << std::endl <<
+                "  --scene NAME     A scene file, or a built-in scene (default spheres); one of:";
+        for (const std::string& name : Scene::builtins())
+            std::cerr << " " << name;
+        std::cerr << std::endl <<
+                "  --width N        Width of the image in pixels (default 800)" << std::endl <<
+                "  --height N       Height of the image in pixels (default 600)" << std::endl <<
+                "  --threads N      How many threads to render on (default all cores)" << std::endl <<
+                "  --fast           Flat colors only, as the live view's preview" << std::endl <<
+                "  --no-cache       Always load a scene file from its text, and don't write a binary cache of it" << std::endl <<
+                "  --output FILE    Where to write the png (default render.png)" << std::endl <<
+                "  --heatmap FILE   Also write a png of how long each pixel took, in false colour" << std::endl <<
+                "  --trace FILE     Write a timeline of the run, for chrome://tracing or ui.perfetto.dev" << std::endl;
+    }
+
+    // Read the command line into options. Returns false if it couldn't be understood.
+    bool parse(int argc, char* argv[], Options& options) {
+        for (int i = 1; i < argc; i++) {
+            std::string arg = argv[i];
+            bool hasValue = i + 1 < argc;
+
+            if (arg == "--fast") {
+                options.fast = true;
+            } else if (arg == "--no-cache") {
+                options.cache = false;
+            } else if (arg == "--scene" && hasValue) {
+                options.scene = argv[++i];
+            } else if (arg == "--output" && hasValue) {
+                options.output = argv[++i];
+            } else if (arg == "--heatmap" && hasValue) {
+                options.heatmap = argv[++i];
+            } else if (arg == "--trace" && hasValue) {
+                options.trace = argv[++i];
+            } else if (arg == "--width" && hasValue) {
+                options.width = std::atoi(argv[++i]);
+            } else if (arg == "--height" && hasValue) {
+                options.height = std::atoi(argv[++i]);
+            } else if (arg == "--threads" && hasValue) {
+                options.threads = std::atoi(argv[++i]);
+            } else {
+                std::cerr << "Unknown or incomplete option " << arg << std::endl;
+                return false;
+            }
+        }
+
+        if (options.width <= 0 || options.height <= 0 || options.threads < 0) {
+            std::cerr << "The image size and thread count must be positive." << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    long long microseconds(std::chrono::steady_clock::duration d) {
+        return std::chrono::duration_cast<std::chrono::microseconds>(d).count();
+    }
+}
+
+int main(int argc, char* argv[]) {
+    Options options;
+    if (!parse(argc, argv, options)) {
+        usage();
+        return 2;
+    }
+
+    if (options.threads > 0) omp_set_num_threads(options.threads);
+    if (!options.trace.empty()) Trace::Recorder::get().start();
+
+    auto loadStart = std::chrono::steady_clock::now();
+    Scene scene;
+    SceneLoadStats loaded;
+    if (!Scene::builtin(options.scene, scene)) {
+        std::string error;
+        bool found = options.cache ? Scene::loadFileCached(options.scene, scene, error, &loaded)
+                                   : Scene::loadFile(options.scene, scene, error, &loaded);
+        if (!found) {
+            std::cerr << options.scene << ": " << error << std::endl;
+            return 1;
+        }
+    }
+    Camera cam = scene.camera(options.width, options.height);
+    Framebuffer canvas(options.width, options.height);
+    // Timing every pixel isn't free, so it's only done if the heatmap was asked for.
+    std::unique_ptr<Heatmap> costs;
+    if (!options.heatmap.empty()) costs = std::make_unique<Heatmap>(options.width, options.height);
+
+    auto renderStart = std::chrono::steady_clock::now();
+    RenderStats stats = scene.world.renderRT(cam, canvas, 0, 0, options.width, options.height, options.fast, std::cerr, costs.get());
+
+    auto writeStart = std::chrono::steady_clock::now();
+    if (!canvas.export_png(options.output)) {
+        std::cerr << "Couldn't write " << options.output << std::endl;
+        return 1;
+    }
+    if (costs) {
+        Framebuffer heat(options.width, options.height);
+        costs->paint(heat);
+        if (!heat.export_png(options.heatmap)) {
+            std::cerr << "Couldn't write " << options.heatmap << std::endl;
+            return 1;
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    if (!options.trace.empty()) {
+        Trace::Recorder::get().stop();
+        std::ofstream out(options.trace);
+        Trace::Recorder::get().write(out);
+        if (!out) {
+            std::cerr << "Couldn't write " << options.trace << std::endl;
+            return 1;
+        }
+    }
+
+    long long renderUs = microseconds(writeStart - renderStart);
+    double nsPerPixel = (double) std::chrono::duration_cast<std::chrono::nanoseconds>(writeStart - renderStart).count()
+            / ((double) options.width * options.height);
+
+    std::cout << "{\"scene\":" << jsonString(options.scene) << ",\"width\":" << options.width << ",\"height\":" << options.height <<
+            ",\"threads\":" << omp_get_max_threads() << ",\"fast\":" << (options.fast ? "true" : "false") <<
+            ",\"objects\":" << scene.world.numObjs << ",\"load_us\":" << microseconds(renderStart - loadStart) <<
+            ",\"cached\":" << (loaded.cached ? "true" : "false") << ",\"parse_us\":" << microseconds(loaded.parse) << ",\"build_us\":" << microseconds(loaded.build) << ",\"render_us\":" << renderUs <<
+            ",\"ns_per_pixel\":" << nsPerPixel << ",\"rays\":" << stats.rays() << ",\"intersection_tests\":" << stats.intersectionTests() << ",\"write_us\":" << microseconds(end - writeStart) <<
+            ",\"output\":" << jsonString(options.output) << "}" << std::endl;
+    return 0;
+}
+
+// Compare two doubles with tolerance.
+bool safeCompare(double a, double b) {
+    return std::abs(a - b) < 0.001;
+}
@@ -8,6 +8,12 @@
 #include <fstream>
 #include "render/Geometry.h"
 #include "view/World.h"
+#include "render/RenderPool.h"
+#include "view/InfluenceMap.h"
+#include "view/Reprojection.h"
+#include "view/DoubleBuffer.h"
+#include "view/Heatmap.h"
+#include "view/Scene.h"
 #define OLC_PGE_APPLICATION
 #include "olcPixelGameEngine.h"
 #define OLC_PGEX_QUICKGUI
@@ -21,7 +27,17 @@ int frameheight = 600;
 
 class FramebufferView : public olc::PixelGameEngine {
     // Render Elements
-    Framebuffer frame;
+    // The render threads draw into the back buffer; finished tiles are copied to the front one to be shown.
+    DoubleBuffer frame;
+    // The engine layer that holds the image, under the GUI. It's only refilled, and sent to the GPU, when a tile is published.
+    uint8_t imageLayer = 0;
+    // How long each pixel took to trace, and the false colour image of it shown in place of the render. Press H to toggle.
+    // Pixels are only timed while it's shown.
+    Heatmap costs { framewidth, frameheight };
+    Framebuffer costImage { (size_t) framewidth, (size_t) frameheight };
+    bool showCosts = false;
+    // Has the layer to be refilled even if no tile was published, because what's shown on it was switched?
+    bool layerStale = false;
 
     // The objects and state of the world.
     World w;
@@ -29,23 +45,53 @@ class FramebufferView : public olc::PixelGameEngine {
     Camera cam;
     // A copy of the camera, used for the base position at the start of an arcball rotation.
     Camera camCached;
-
-    // The thread that actually renders things to the active framebuffer, so that we can deal with user input and drawing things separately.
-    std::thread raytraceThread;
+    // What went into each tile of the frame, so that an edit only traces again the tiles it could have changed.
+    InfluenceMap influence { framewidth, frameheight };
+    // The hit behind every pixel of the frame, so that a frame from a moved camera can start from the last one.
+    Reprojection history { framewidth, frameheight };
+    // Has the view changed since the last frame in a way that means every tile has to be traced again?
+    bool viewChanged = true;
+    // Has the camera orbited since the last frame? If so, the last frame is reprojected rather than traced again.
+    bool cameraMoved = false;
+    // Has the world been edited since the last frame? If so, reprojecting the last frame would show it as it was.
+    bool worldEdited = false;
+
+    // The threads that actually render things to the active framebuffer, so that we can deal with user input and drawing things separately.
+    // Declared after everything the render jobs read, so that it's shut down before any of it is destroyed.
+    RenderPool pool { std::max(1u, std::thread::hardware_concurrency()) };
+    // The generation of the newest frame given to the pool.
+    uint64_t currentFrame = 0;
+    // When the newest frame was started, and whether its timing has been printed yet.
+    std::chrono::steady_clock::time_point frameStart;
+    bool frameReported = false;
+
+    // Frames are rendered coarse to fine: first every step'th pixel splatted into blocks, then every step/2'th, down to every pixel.
+    // The first level of a frame should land within this long, however complex the scene is.
+    static constexpr double firstLevelBudgetNs = 8e6;
+    // The coarsest step, while there's no idea yet of how long a pixel takes.
+    static constexpr int defaultStep = 8;
+    // Blocks any bigger than a tile would spill into their neighbours.
+    static constexpr int maxStep = TileScheduler::defaultTileSize;
+    // How long tracing a pixel takes, going by the frames so far.
+    double nsPerPixel = 0;
+    // The tiles of the newest frame, its coarsest step, whether it was reprojected, and how many of its levels have been timed.
+    std::vector<Tile> frameTiles;
+    int frameStep = defaultStep;
+    bool frameReprojected = false;
+    size_t levelsTimed = 0;
 
     std::atomic_bool mouseReleased = false;
-    // Should another frame start rendering as soon as the current is finished?
+    // Should another frame start rendering? Whatever frame is in flight is abandoned for it.
     std::atomic_bool rerender = false;
-    // Is the current frame finished rendering?
-    std::atomic_bool renderComplete = false;
-    // Should a faster, simplified method of rendering be used?
-    std::atomic_bool renderPreview = false;
     // Is this the first frame being rendered?
     bool firstFrame = true;
 
     // The x and y that the currently held click started at.
     float mouseXClickStart = 0;
     float mouseYClickStart = 0;
+    // Where the mouse was when the camera was last moved, so that holding it still doesn't restart the frame.
+    int lastMouseX = -1;
+    int lastMouseY = -1;
 
     // GUI elements
     QuickGUI::Manager gui;
@@ -70,47 +116,120 @@ class FramebufferView : public olc::PixelGameEngine {
 public:
 
     // The function called when a new frame is to be rendered.
-    // Dispatches threads to do the actual work.
+    // Hands the frame to the render pool, abandoning the one in flight. Only the tiles that the edits since the last frame
+    // could have changed are traced. The jobs render from their own copy of the camera, so it can keep moving while they work.
+    // While the camera orbits, the last frame is reprojected to the new camera and only what that leaves uncovered is traced.
     void render() {
-        w.renderRT(cam, frame, 0, 0, framewidth, frameheight, renderPreview);
-        renderComplete = true;
+        // The records of the tiles about to be traced are cleared, so nothing can still be writing to them.
+        pool.cancel();
         rerender = false;
+
+        bool reprojecting = cameraMoved && !viewChanged && !worldEdited;
+        std::vector<Tile> tiles;
+        if (reprojecting) {
+            history.reproject(cam, frame.back());
+            frame.publishAll();
+            // Influence records only hold for the camera they were made with, so none are kept until the camera settles.
+            influence.invalidateAll();
+            for (const Tile& tile : influence.dirty())
+                if (history.needsTrace(tile)) tiles.emplace_back(tile);
+        } else {
+            if (viewChanged || cameraMoved) influence.invalidateAll();
+            tiles = influence.dirty();
+            for (const Tile& tile : tiles) {
+                influence.at(tile).clear();
+                history.traceAll(tile);
+            }
+        }
+
+        viewChanged = false;
+        cameraMoved = false;
+        worldEdited = false;
+        if (tiles.empty()) return;
+
+        // A reprojected frame is mostly filled in already; blocks from a coarse level would only cover that up.
+        Camera view = cam;
+        int start = reprojecting ? 1 : coarsestStep(tiles);
+
+        // One pass per level, each over every dirty tile.
+        std::vector<std::vector<Tile>> levels;
+        for (int step = start; step >= 1; step /= 2)
+            levels.push_back(tiles);
+
+        Heatmap* timing = showCosts ? &costs : nullptr;
+        currentFrame = pool.submit(std::move(levels), [this, view, start, reprojecting, timing](const Tile& tile, uint64_t generation, size_t level) {
+            Trace::Scope trace("tile");
+            int step = start >> level;
+            TileInfluence* record = reprojecting ? nullptr : &influence.at(tile);
+            // Check between rows, so that a superseded frame is dropped quickly even in the middle of a slow tile.
+            // Whatever made it into the tile is published either way; the next frame starts from the back buffer as it is.
+            frame.beginTile(tile);
+            for (int y = tile.fromY; y < tile.toY && pool.current(generation); y++)
+                w.renderTile(view, frame.back(), { tile.fromX, y, tile.toX, y + 1 }, false, step, level == 0, record, &history, timing);
+            frame.publishTile(tile);
+
+            if (record && step == 1 && pool.current(generation)) record->valid = true;
+        });
+
+        frameStart = std::chrono::steady_clock::now();
+        frameReported = false;
+        frameTiles = std::move(tiles);
+        frameStep = start;
+        frameReprojected = reprojecting;
+        levelsTimed = 0;
     }
 
-    FramebufferView() : frame { Framebuffer(1, 1) } {
+    // How many pixels of the tiles are traced by the levels down to and including the given step; every pixel on its grid.
+    static size_t tracedPixels(const std::vector<Tile>& tiles, int step) {
+        size_t pixels = 0;
+        for (const Tile& t : tiles)
+            pixels += (size_t) ((t.toX - t.fromX + step - 1) / step) * ((t.toY - t.fromY + step - 1) / step);
+        return pixels;
+    }
+
+    // The step of the first level of a frame: the finest whose pixels can all be traced within the budget.
+    int coarsestStep(const std::vector<Tile>& tiles) const {
+        double cost = nsPerPixel;
+        if (cost <= 0) return defaultStep;
+
+        int step = 1;
+        while (step < maxStep && cost * (double) tracedPixels(tiles, step) > firstLevelBudgetNs)
+            step *= 2;
+        return step;
+    }
+
+    // Update how long a pixel takes, from the levels of the newest frame that have finished since we last looked.
+    // The time is only checked once per update, so this errs on the slow side, which errs towards a coarser first level.
+    // Reprojected frames trace only scattered pixels, so there's no telling how many, and they aren't timed.
+    void timeLevels() {
+        if (frameReprojected) return;
+        size_t levels = pool.passesFinished();
+        if (levels <= levelsTimed) return;
+        levelsTimed = levels;
+
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - frameStart);
+        nsPerPixel = (double) elapsed.count() / (double) tracedPixels(frameTiles, frameStep >> (levels - 1));
+    }
+
+    FramebufferView() : frame(framewidth, frameheight) {
         // Name your application
         sAppName = "Bouncer Live View";
 
-        // Set up world geometry; three spheres.
-        auto* one = new Sphere;
-        one->setMatrix(Matrix::scaling(100, 100, 100));
-        one->material.color = Color(1.0, 0, 0);
-        auto* two = new Sphere;
-        two->setMatrix(Matrix::translation(100, 0, 200) * Matrix::scaling(100, 100, 100));
-        auto* three = new Sphere;
-        three->setMatrix(Matrix::translation(-100, 0, -200) * Matrix::scaling(100, 100, 100));
-        auto* four = new Sphere;
-        four->setMatrix(Matrix::translation(200, 200, 200) * Matrix::scaling(100, 100, 100));
-
-        // Set up the world objects and a light.
-        w = World(
-                { one, two, three, four },
-                { { -50, 100, -250 }, { 1, 1, 1 } }
-        );
-
-        // Set up a camera that can be manipulated.
-        cam = Camera(framewidth, frameheight, M_PI / 3);
-        cam.setTransform({ 0, 0, -1500 }, { 0, 0, 0 }, { 0, 1, 0 });
-
-        frame = Framebuffer(cam.horizontalSize, cam.verticalSize);
+        // Set up the world, and a camera that can be manipulated.
+        Scene scene = Scene::spheres();
+        w = std::move(scene.world);
+        cam = scene.camera(framewidth, frameheight);
 
         // Immediately start rendering the first frame.
-        raytraceThread = std::thread(&FramebufferView::render, this);
+        render();
     }
 
 public:
     // Set up GUI elements such as the sliders and lists.
     bool OnUserCreate() override {
+        imageLayer = (uint8_t) CreateLayer();
+        EnableLayer(imageLayer, true);
+
         colorRedSlider = new Slider(gui, { 150.0f, 30.0f }, { 246.0f, 30.0f }, 0, 255, 128);
         colorGreenSlider = new Slider(gui, { 150.0f, 50.0f }, { 246.0f, 50.0f }, 0, 255, 128);
         colorBlueSlider = new Slider(gui, { 150.0f, 70.0f }, { 246.0f, 70.0f }, 0, 255, 128);
@@ -165,6 +284,10 @@ public:
 
     // Update the camera's angles using the mouse movement delta.
     void updateCameraAngles() {
+        if (GetMouseX() == lastMouseX && GetMouseY() == lastMouseY) return;
+        lastMouseX = GetMouseX();
+        lastMouseY = GetMouseY();
+
         float ndcX = 2.0f * GetMouseX() / (float) framewidth - 1;
         float ndcY = 1.0f - 2.0f * GetMouseY() / (float) frameheight;
 
@@ -174,14 +297,15 @@ public:
         Vector dir = currentMousePoint - cachedMousePoint;
         // The matrix dealing with the rotation brought about by the X movement of the mouse.
         // To move horizontally, we rotate around the Y axis.
-        Matrix xMat = Matrix::rotation_y(dir.x * M_PI);
+        Mat4 xMat = Mat4::rotation_y(dir.x * M_PI);
         // The matrix dealing with the rotation brought about by the Y movement of the mouse.
         // To move vertically, we rotate around the X axis.
-        Matrix yMat = Matrix::rotation_x(dir.y * M_PI);
+        Mat4 yMat = Mat4::rotation_x(dir.y * M_PI);
 
         // To avoid accidentally rotating around the Z axis, we rotate the cached camera position rather than the current.
         // To ensure that the camera rotates in an arcball-like fashion, we rotate the X after the Y; otherwise we rotate the camera's yaw rather than the position.
         cam.setTransform(camCached.transform * yMat * xMat);
+        cameraMoved = true;
         rerender = true;
     }
 
@@ -189,6 +313,11 @@ public:
     void updateSliders() {
         bool pointLightSelected = objectList->nSelectedItem >= w.numObjs;
         bool selectionChanged = objectList->nSelectedItem != objectList->nPreviouslySelectedItem || firstFrame;
+        bool slidersChanged = colorRedSlider->changed || colorGreenSlider->changed
+                || colorBlueSlider->changed || reflectivitySlider->changed
+                || transparencySlider->changed || diffuseSlider->changed
+                || ambientSlider->changed || positionXSlider->changed
+                || positionYSlider->changed || positionZSlider->changed;
 
         // Check for whether the point light is selected! The rest of this function assumes the index is valid.
         if (pointLightSelected) {
@@ -205,10 +334,16 @@ public:
                 positionXSlider->fValue = (float) w.lightSource.position.x;
                 positionYSlider->fValue = (float) w.lightSource.position.y;
                 positionZSlider->fValue = (float) w.lightSource.position.z;
-            } else {
+            } else if (slidersChanged) {
+                // The render threads read the light, so stop them before changing it.
+                pool.cancel();
+                worldEdited = true;
                 w.lightSource.position = { positionXSlider->fValue, positionYSlider->fValue, positionZSlider->fValue };
                 w.lightSource.intensity = { colorRedSlider->fValue, colorGreenSlider->fValue, colorBlueSlider->fValue };
+                influence.lightChanged();
+                rerender = true;
             }
+            resetSliders();
             return;
         }
 
@@ -233,12 +368,13 @@ public:
             return;
         }
 
-        // Tell the engine to rerender if any parameters have changed.
-        rerender = rerender | (colorRedSlider->changed || colorGreenSlider->changed
-                || colorBlueSlider->changed || reflectivitySlider->changed
-                || transparencySlider->changed || diffuseSlider->changed
-                || ambientSlider->changed || positionXSlider->changed
-                || positionYSlider->changed || positionZSlider->changed);
+        if (!slidersChanged) return;
+
+        // Tell the engine to rerender, since parameters have changed.
+        // The render threads read the world, so stop them before changing it.
+        pool.cancel();
+        worldEdited = true;
+        rerender = true;
 
         // Next, set the new values from the sliders.
         // Because of the above checks, this shouldn't change anything even when switching to a new object.
@@ -250,10 +386,19 @@ public:
         // Update the object's position with the object's matrix with an updated position.
         // A little roundabout, but that's the price we pay for performance.
 
-        if (positionXSlider->changed || positionYSlider->changed || positionZSlider->changed)
+        influence.objectChanged(obj);
+        if (positionXSlider->changed || positionYSlider->changed || positionZSlider->changed) {
+            Bounds before = obj->worldBounds();
             obj->setMatrix(obj->transform.setTranslation({ positionXSlider->fValue, positionYSlider->fValue, positionZSlider->fValue }));
+            w.buildAccel();
+            influence.objectMoved(obj, before, obj->worldBounds(), cam, w.lightSource);
+        }
 
-        // Reset all the sliders, so we don't get continuous updates.
+        resetSliders();
+    }
+
+    // Reset all the sliders, so we don't get continuous updates.
+    void resetSliders() {
         colorRedSlider->changed = false;
         colorGreenSlider->changed = false;
         colorBlueSlider->changed = false;
@@ -268,67 +413,102 @@ public:
 
     // Called every frame of the window the user sees; separated from the actual image being generated.
     bool OnUserUpdate(float fElapsedTime) override {
+        Trace::Scope trace("gui frame");
         gui.Update(this);
 
-        // Cache the mouse released event, so that we can properly disable the preview mode and render a shaded image.
+        // Cache the mouse released event, so that we can properly render a clean image once the camera settles.
         if (GetMouse(0).bReleased)
             mouseReleased = true;
 
         // If the mouse is pressed, start rotating the camera.
         // We do this by tracking where the mouse started, and the camera's first position and rotation.
-        // While rotating, we also start rendering in a faster, simpler preview of objects' colors and positions.
+        // While rotating, each frame starts from the last one, reprojected to the new camera.
         if (GetMouse(0).bPressed) {
             mouseXClickStart = 2.0f * GetMouseX() / (float) framewidth - 1;
             mouseYClickStart = 1.0f - 2.0f * GetMouseY() / (float) frameheight;
             camCached = cam;
-            renderPreview = true;
         }
 
-        // Don't do any render-thread manipulation unless an image is finished; an async semaphore.
-        if (renderComplete) {
-            // If the current render job is finished, destroy its thread
-            if (raytraceThread.joinable()) raytraceThread.join();
+        // Update the camera when holding the mouse!
+        if (GetMouse(0).bHeld || GetMouse(0).bReleased) {
+            updateCameraAngles();
+        }
 
-            // Update the camera when holding the mouse!
-            if (GetMouse(0).bHeld || GetMouse(0).bReleased) {
-                updateCameraAngles();
-            }
+        // If the mouse release "event" is waiting, handle it now.
+        if (mouseReleased) {
+            viewChanged = true;         // Reprojection leaves highlights where they were; trace everything again now.
+            rerender = true;            // Render a new, clean image now.
+            mouseReleased = false;      // The event is handled, so reset it.
+        }
 
-            // If the mouse release "event" is waiting, handle it now.
-            if (mouseReleased) {
-                renderPreview = false;      // Stop rendering the preview
-                rerender = true;            // Render a new, non-preview image now.
-                mouseReleased = false;      // The event is handled, so reset it.
-            }
+        // Update and apply the sliders. Anything that changes the world stops the render threads first.
+        updateSliders();
 
-            // Now that nothing is reading the data of the sliders, we can update and change them.
-            updateSliders();
+        // If another frame needs to start, start it immediately; the newest camera and scene always win over the frame in flight.
+        if (rerender) render();
 
-            // If another frame needs to start,
-            if (rerender) {
-                // Start it immediately.
-                renderComplete = false;
-                raytraceThread = std::thread(&FramebufferView::render, this);
-            }
+        // Tell the rest of the program that the first frame is over
+        if (firstFrame) firstFrame = false;
 
-            // Tell the rest of the program that the first frame is over
-            if (firstFrame) firstFrame = false;
+        // Some performance detail, once the newest frame is done.
+        timeLevels();
+        if (!frameReported && pool.finished(currentFrame)) {
+            auto elapsed = std::chrono::steady_clock::now() - frameStart;
+            std::cout << "Frame " << currentFrame << " rendered in " << std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count() << "us" << std::endl;
+            frameReported = true;
         }
 
-
         // Asynchronously from the actual image being rendered, we can still draw it to the screen.
-        // This should be somewhat seamless, as long as the image can be rendered fast enough.
+        // Only whole tiles are shown, so a tile is never seen half way between two levels or two frames.
+        // The packed colors are already laid out as the engine's pixels, so the image goes across in one copy.
         (void) fElapsedTime;
-        for (size_t x = 0; x < frame.width; x++)
-            for (size_t y = 0; y < frame.height; y++) {
-                Draw(x, y, olc::Pixel(frame.at(x, y)));
-            }
+        if (frame.present() > 0 || layerStale) {
+            layerStale = false;
+            if (showCosts) costs.paint(costImage);
+            Framebuffer& shown = showCosts ? costImage : frame.front();
+            olc::Sprite* image = GetLayers()[imageLayer].pDrawTarget.Sprite();
+            static_assert(sizeof(olc::Pixel) == sizeof(uint32_t), "The image is copied into the sprite as packed 32 bit pixels");
+            std::memcpy(static_cast<void*>(image->GetData()), shown.row(0), shown.width * shown.height * sizeof(uint32_t));
+            GetLayers()[imageLayer].bUpdate = true;
+        }
+
+        // The GUI is drawn from scratch every frame, on a clear layer over the image.
+        Clear(olc::BLANK);
 
         // A shortcut; press enter to save a png of what's on screen.
         if (PixelGameEngine::GetKey(olc::Key::ENTER).bPressed) {
-            frame.export_png("pic2.png");
+            bool saved = frame.front().export_png("pic2.png");
+            if (showCosts) saved = costImage.export_png("pic2-heat.png") && saved;
+
+            std::cout << (saved ? "Image saved." : "Couldn't save the image.") << std::endl;
+        }
 
-            std::cout << "Image saved." << std::endl;
+        // A shortcut; press H to switch between the render and how long each pixel of it took.
+        // Pixels are only timed while the heatmap is shown, so switching to it traces the whole frame again.
+        if (PixelGameEngine::GetKey(olc::Key::H).bPressed) {
+            showCosts = !showCosts;
+            layerStale = true;
+            if (showCosts) {
+                pool.cancel();
+                costs.clear();
+                viewChanged = true;
+                rerender = true;
+            }
+        }
+
+        // A shortcut; press T to start tracing what every thread does, and again to stop and save the timeline to trace.json.
+        // Open it in chrome://tracing or ui.perfetto.dev.
+        if (PixelGameEngine::GetKey(olc::Key::T).bPressed) {
+            Trace::Recorder& recorder = Trace::Recorder::get();
+            if (!recorder.enabled()) {
+                recorder.start();
+                std::cout << "Tracing." << std::endl;
+            } else {
+                recorder.stop();
+                std::ofstream out("trace.json");
+                recorder.write(out);
+                std::cout << (out ? "Trace saved." : "Couldn't save the trace.") << std::endl;
+            }
         }
 
         // A shortcut; press esc to close.
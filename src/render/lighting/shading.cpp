@@ -3,7 +3,7 @@
 namespace Light {
 
     // Phong Shading Lighting workhouse.
-    inline Color lighting(Material m, Geo* object, PointLight light, const Point& position, const Vector& eyev, const Vector& normalv, bool inShadow) {
+    Color lighting(Material m, Geo* object, PointLight light, const Point& position, const Vector& eyev, const Vector& normalv, bool inShadow) {
         Color materialColor = m.pattern != nullptr ? Pattern::colorAt(position, object) : m.color;
 
         Color effectiveColor = materialColor * light.intensity;
@@ -13,15 +13,15 @@ namespace Light {
         Color diffuse(0, 0, 0);
         Color specular(0, 0, 0);
 
-        double lDotNorm = lightV * normalv;
+        Scalar lDotNorm = lightV * normalv;
         if (lDotNorm > 0 && !inShadow) {
             diffuse = effectiveColor * m.diffuse * lDotNorm;
 
             Vector reflectV = (-lightV).reflect(normalv);
-            double reflectDot = reflectV * eyev;
+            Scalar reflectDot = reflectV * eyev;
 
             if (reflectDot > 0) {
-                double factor = std::pow(reflectDot, m.shininess);
+                Scalar factor = std::pow(reflectDot, m.shininess);
                 specular = light.intensity * m.specular * factor;
             }
         }
@@ -31,15 +31,18 @@ namespace Light {
 
     // A wrapper that redirects to the other `lighting` function, with shadows disabled.
     // Exists to expose lighting to tests.
-    inline Color lighting(Material m, Geo* object, const PointLight& light, const Point& position, const Vector& eyev, const Vector& normalv) {
+    Color lighting(Material m, Geo* object, const PointLight& light, const Point& position, const Vector& eyev, const Vector& normalv) {
         return lighting(m, object, light, position, eyev, normalv, false);
     }
 
     // Generate and calculate the color of a reflection from the given point.
-    inline Color reflected(World& w, RT::IntersectionDetail details, int countdown) {
+    Color reflected(World& w, RT::IntersectionDetail details, int countdown) {
         if (details.object.material.reflectivity == 0) return Color::black();
         if (countdown < 1) return Color::black();
 
+        if (TileInfluence* influence = TileInfluence::recording()) influence->secondary = true;
+
+        RenderStats::count(RenderStats::ReflectionRays);
         RT::Ray reflectRay { details.overPoint, details.reflectv };
         Color color = Light::at(w, reflectRay, countdown - 1);
 
@@ -47,24 +50,27 @@ namespace Light {
     }
 
     // Generate and calculate the color of a refraction from the given point.
-    inline Color refracted(World& w, RT::IntersectionDetail details, int countdown) {
+    Color refracted(World& w, RT::IntersectionDetail details, int countdown) {
         if (details.object.material.transparency == 0) return Color::black();
         if (countdown < 1) return Color::black();
 
+        if (TileInfluence* influence = TileInfluence::recording()) influence->secondary = true;
+
         // Check for Total Internal Reflection; derived from Snell's Law
-        double ratio = details.refractiveIdxIncoming / details.refractiveIdxOutgoing;
+        Scalar ratio = details.refractiveIdxIncoming / details.refractiveIdxOutgoing;
         // cos_i = cosine of the angle between the incoming ray and the surface.
-        double cosi = details.eyev * details.normalv;
+        Scalar cosi = details.eyev * details.normalv;
         // sin^2_t =
-        double sin2t = (ratio*ratio) * (1 - (cosi*cosi));
+        Scalar sin2t = (ratio*ratio) * (1 - (cosi*cosi));
 
         if(sin2t > 1)
             return Color::black();
 
         // Cast the refracted ray
-        double cost = std::sqrt((double) 1.0 - sin2t);
+        Scalar cost = std::sqrt((Scalar) 1.0 - sin2t);
         Vector dir = details.normalv * (ratio * cosi - cost) - details.eyev * ratio;
 
+        RenderStats::count(RenderStats::RefractionRays);
         RT::Ray refract { details.underPoint, dir };
         Color col = Light::at(w, refract, countdown - 1);
 
@@ -72,45 +78,45 @@ namespace Light {
     }
 
     // Trace a ray from the point to the nearest light source, and determine whether there is something blocking it.
-    inline bool isInShadow(World& world, Point& point) {
+    bool isInShadow(World& world, Point& point) {
         Vector v = world.lightSource.position - point;
-        double distance = v.magnitude();
+        Scalar distance = v.magnitude();
         Vector direction = Vector(v.normalize());
 
+        RenderStats::count(RenderStats::ShadowRays);
         RT::Ray r { point, direction };
-        RT::Intersections sections = world.intersect(r);
-
-        RT::Intersection hit = sections.hit();
-        return (!hit.isEmpty() && hit.time < distance);
+        return world.occluded(r, distance);
     }
 
     // Using the Schlick approximation of the Fresnel effect.
-    // The returned double is the ratio between reflection and refraction in the final ray.
-    inline double fresnelContribution(RT::IntersectionDetail& detail) {
-        double cos = detail.eyev * detail.normalv;
+    // The returned value is the ratio between reflection and refraction in the final ray.
+    Scalar fresnelContribution(RT::IntersectionDetail& detail) {
+        Scalar cos = detail.eyev * detail.normalv;
 
         if (detail.refractiveIdxIncoming > detail.refractiveIdxOutgoing) {
-            double ratio = detail.refractiveIdxIncoming / detail.refractiveIdxOutgoing;
-            double sin2t = ratio * ratio * ( 1 - cos * cos);
+            Scalar ratio = detail.refractiveIdxIncoming / detail.refractiveIdxOutgoing;
+            Scalar sin2t = ratio * ratio * ( 1 - cos * cos);
             if (sin2t > 1) return 1;
 
-            double cost = std::sqrt(1 - sin2t);
+            Scalar cost = std::sqrt(1 - sin2t);
             cos = cost;
         }
 
-        double r0 = std::pow((detail.refractiveIdxIncoming - detail.refractiveIdxOutgoing) / (detail.refractiveIdxIncoming + detail.refractiveIdxOutgoing), 2);
+        Scalar r0 = std::pow((detail.refractiveIdxIncoming - detail.refractiveIdxOutgoing) / (detail.refractiveIdxIncoming + detail.refractiveIdxOutgoing), 2);
         return std::pow(r0 + (1 - r0) * (1-cos), 5);
     }
 
     // Calculate the final color of an interection by summing up the Phong lighting, the reflections, and refractions of a point.
-    inline Color shadeHit(World& world, RT::IntersectionDetail& hit, int countdown) {
+    Color shadeHit(World& world, RT::IntersectionDetail& hit, int countdown) {
+        if (TileInfluence* influence = TileInfluence::recording()) influence->shaded(hit.overPoint);
+
         Color rayTarget = lighting(hit.object.material, &hit.object, world.lightSource, hit.overPoint, hit.eyev, hit.normalv, Light::isInShadow(world, hit.overPoint));
         Color reflectedRay = Light::reflected(world, hit, countdown);
         Color refractedRay = Light::refracted(world, hit, countdown);
 
         Material mat = hit.object.material;
         if (mat.reflectivity > 0 && mat.transparency > 0) {
-            double reflectance = fresnelContribution(hit);
+            Scalar reflectance = fresnelContribution(hit);
             return rayTarget + (reflectedRay * reflectance) + (refractedRay * (1 - reflectance));
         } else {
             return refractedRay + rayTarget + reflectedRay;
@@ -118,17 +124,36 @@ namespace Light {
     }
 
     // Calculate the color at the intersection between the ray and the world.
-    Color at(World& w, RT::Ray r, int countdown, bool simpleMode) {
-        RT::Intersections isections = w.intersect(r);
-        RT::Intersection hit = isections.hit();
-
-        if (hit.time == -1 && hit.object == nullptr) return Color::black();
+    Color at(World& w, RT::Ray r, int countdown, bool simpleMode, RT::Intersection* primary) {
+        RenderStats::traced(countdown < maxBounces ? maxBounces - countdown : 0);
+
+        RT::Ray front { r.origin, r.direction, 0, r.tMax };
+        RT::Intersection hit = w.closestHit(front);
+        if (primary) *primary = hit;
+        if (hit.isEmpty()) return Color::black();
+
+        TileInfluence* influence = TileInfluence::recording();
+        if (influence) influence->hit(hit.object);
+
+        // The preview only draws flat colors, so the hit itself is all it needs.
+        if (simpleMode) return hit.object->material.color;
+
+        // The refractive indices either side of the hit only matter if light can pass through it.
+        // Working them out needs every intersection along the ray, so only collect them when they're needed.
+        unsigned needs = hit.detailNeeds();
+        if (!(needs & RT::NeedsRefraction)) {
+            RT::Intersections isections { hit };
+            RT::IntersectionDetail detail = RT::Intersection::fillDetail(hit, r, isections, needs);
+            return shadeHit(w, detail, countdown);
+        }
 
-        RT::IntersectionDetail detail = RT::Intersection::fillDetail(hit, r, isections);
+        RT::Intersections isections = w.intersect(r);
+        // Every object along the ray has a say in the refractive indices either side of the hit.
+        if (influence)
+            for (const RT::Intersection& i : isections)
+                influence->hit(i.object);
 
-        if (simpleMode)
-            return detail.object.material.color;
-        else
-            return shadeHit(w, detail, countdown);
+        RT::IntersectionDetail detail = RT::Intersection::fillDetail(hit, r, isections, needs);
+        return shadeHit(w, detail, countdown);
     }
-}
\ No newline at end of file
+}
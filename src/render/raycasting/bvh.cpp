@@ -0,0 +1,259 @@
+#include <render/BVH.h>
+#include <render/Geometry.h>
+#include <core/Trace.h>
+
+void BVH::build(Geo* const* objects, size_t count) {
+    Trace::Scope trace("build acceleration");
+    nodes.clear();
+    prims.clear();
+    unbounded.clear();
+
+    std::vector<BuildPrim> work;
+    work.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        Bounds box = objects[i]->worldBounds();
+        if (box.isInfinite()) {
+            unbounded.emplace_back(objects[i]);
+            continue;
+        }
+
+        work.push_back({ box, { box.centroid(0), box.centroid(1), box.centroid(2) }, objects[i] });
+    }
+
+    if (work.empty()) return;
+
+    // A binary tree with n leaves has at most 2n - 1 nodes; the build claims them from this pool as it goes.
+    nodes.resize(2 * work.size() - 1);
+    std::atomic<uint32_t> nodesUsed { 1 };
+
+    #pragma omp parallel default(none) shared(work, nodesUsed)
+    #pragma omp single
+    buildNode(work, nodesUsed, 0, 0, work.size(), 0);
+
+    nodes.resize(nodesUsed);
+    prims.reserve(work.size());
+    for (BuildPrim& p : work)
+        prims.emplace_back(p.object);
+}
+
+void BVH::buildNode(std::vector<BuildPrim>& work, std::atomic<uint32_t>& nodesUsed, uint32_t nodeIdx, size_t begin, size_t end, int depth) {
+    Node& node = nodes[nodeIdx];
+    size_t count = end - begin;
+
+    Bounds centroids;
+    for (size_t i = begin; i < end; i++) {
+        node.box.extend(work[i].box);
+        centroids.extend(work[i].centroid[0], work[i].centroid[1], work[i].centroid[2]);
+    }
+
+    // Split along the axis the centroids are most spread over.
+    int axis = 0;
+    Scalar extent = centroids.max[0] - centroids.min[0];
+    for (int i = 1; i < 3; i++) {
+        if (centroids.max[i] - centroids.min[i] > extent) {
+            axis = i;
+            extent = centroids.max[i] - centroids.min[i];
+        }
+    }
+
+    // Nothing to gain from splitting; either it's small enough, or every centroid is in the same place.
+    if (count <= minLeafSize || extent <= 0) {
+        node.offset = begin;
+        node.count = count;
+        return;
+    }
+
+    // Drop every primitive into one of a fixed number of bins along the axis.
+    struct Bin {
+        Bounds box;
+        size_t count = 0;
+    } bins[binCount];
+
+    Scalar binScale = binCount / extent;
+    auto binOf = [&](const BuildPrim& p) {
+        int b = (int) ((p.centroid[axis] - centroids.min[axis]) * binScale);
+        return b < binCount ? b : binCount - 1;
+    };
+
+    for (size_t i = begin; i < end; i++) {
+        Bin& bin = bins[binOf(work[i])];
+        bin.box.extend(work[i].box);
+        bin.count++;
+    }
+
+    // Sweep from the right to get the area and count of everything past each plane,
+    // then from the left to evaluate the SAH cost of splitting at each plane.
+    Scalar rightArea[binCount - 1];
+    size_t rightCount[binCount - 1];
+    Bounds sweep;
+    size_t sweepCount = 0;
+    for (int i = binCount - 1; i > 0; i--) {
+        sweep.extend(bins[i].box);
+        sweepCount += bins[i].count;
+        rightArea[i - 1] = sweep.surfaceArea();
+        rightCount[i - 1] = sweepCount;
+    }
+
+    int bestSplit = -1;
+    Scalar bestCost = std::numeric_limits<Scalar>::infinity();
+    sweep = Bounds();
+    sweepCount = 0;
+    for (int i = 0; i < binCount - 1; i++) {
+        sweep.extend(bins[i].box);
+        sweepCount += bins[i].count;
+        if (sweepCount == 0 || rightCount[i] == 0) continue;
+
+        Scalar cost = sweep.surfaceArea() * sweepCount + rightArea[i] * rightCount[i];
+        if (cost < bestCost) {
+            bestCost = cost;
+            bestSplit = i;
+        }
+    }
+
+    // Compare against the cost of intersecting everything here, with a small constant for traversing one more node.
+    Scalar area = node.box.surfaceArea();
+    Scalar leafCost = (Scalar) count;
+    Scalar splitCost = 0.125 + (area > 0 ? bestCost / area : 0);
+    if (bestSplit < 0 || (splitCost >= leafCost && count <= maxLeafSize)) {
+        node.offset = begin;
+        node.count = count;
+        return;
+    }
+
+    auto pivot = std::partition(work.begin() + begin, work.begin() + end,
+                                [&](const BuildPrim& p) { return binOf(p) <= bestSplit; });
+    size_t mid = pivot - work.begin();
+
+    // The bins can't separate these, or the tree is getting too deep for the traversal stack; fall back to an even split on the centroids.
+    if (mid == begin || mid == end || depth >= maxSAHDepth) {
+        mid = begin + count / 2;
+        std::nth_element(work.begin() + begin, work.begin() + mid, work.begin() + end,
+                         [axis](const BuildPrim& a, const BuildPrim& b) { return a.centroid[axis] < b.centroid[axis]; });
+    }
+
+    uint32_t left = nodesUsed.fetch_add(2);
+    node.offset = left;
+    node.count = 0;
+
+    // Big subtrees are handed off to other threads. The implicit barrier at the end of the build's parallel region waits for them.
+    if (count > parallelThreshold) {
+        #pragma omp task default(none) shared(work, nodesUsed) firstprivate(left, begin, mid, depth)
+        buildNode(work, nodesUsed, left, begin, mid, depth + 1);
+    } else {
+        buildNode(work, nodesUsed, left, begin, mid, depth + 1);
+    }
+    buildNode(work, nodesUsed, left + 1, mid, end, depth + 1);
+}
+
+void BVH::intersect(RT::Ray& r, RT::Intersections& s) const {
+    for (Geo* g : unbounded)
+        g->intersect(r, s);
+
+    if (nodes.empty()) return;
+
+    const Scalar origin[3] = { r.origin.x, r.origin.y, r.origin.z };
+    const Scalar invDir[3] = { 1 / r.direction.x, 1 / r.direction.y, 1 / r.direction.z };
+
+    // The build keeps the tree shallower than maxSAHDepth plus a balanced tail, so a fixed stack is fine.
+    uint32_t stack[stackDepth];
+    size_t stackSize = 0;
+    stack[stackSize++] = 0;
+
+    while (stackSize > 0) {
+        const Node& node = nodes[stack[--stackSize]];
+        if (!node.box.intersect(origin, invDir, r.tMin, r.tMax)) continue;
+
+        if (node.count > 0) {
+            for (uint32_t i = node.offset; i < node.offset + node.count; i++)
+                prims[i]->intersect(r, s);
+        } else {
+            stack[stackSize++] = node.offset + 1;
+            stack[stackSize++] = node.offset;
+        }
+    }
+}
+
+bool BVH::occluded(RT::Ray& r, Scalar tMax) const {
+    for (Geo* g : unbounded)
+        if (g->occludes(r, tMax)) return true;
+
+    if (nodes.empty()) return false;
+
+    const Scalar origin[3] = { r.origin.x, r.origin.y, r.origin.z };
+    const Scalar invDir[3] = { 1 / r.direction.x, 1 / r.direction.y, 1 / r.direction.z };
+
+    uint32_t stack[stackDepth];
+    size_t stackSize = 0;
+    stack[stackSize++] = 0;
+
+    while (stackSize > 0) {
+        const Node& node = nodes[stack[--stackSize]];
+        if (!node.box.intersect(origin, invDir, 0, tMax)) continue;
+
+        if (node.count > 0) {
+            for (uint32_t i = node.offset; i < node.offset + node.count; i++)
+                if (prims[i]->occludes(r, tMax)) return true;
+        } else {
+            stack[stackSize++] = node.offset + 1;
+            stack[stackSize++] = node.offset;
+        }
+    }
+
+    return false;
+}
+
+RT::Intersection BVH::closestHit(RT::Ray& r) const {
+    RT::Intersection closest;
+    for (Geo* g : unbounded)
+        g->intersectClosest(r, closest);
+
+    if (nodes.empty()) return closest;
+
+    const Scalar origin[3] = { r.origin.x, r.origin.y, r.origin.z };
+    const Scalar invDir[3] = { 1 / r.direction.x, 1 / r.direction.y, 1 / r.direction.z };
+
+    // Each entry remembers when the ray enters its box, so that it can be dropped without a second slab test
+    // if a closer hit has been found since it was pushed.
+    struct Entry {
+        uint32_t node;
+        Scalar tEntry;
+    } stack[stackDepth];
+    size_t stackSize = 0;
+
+    Scalar tRoot = 0;
+    if (!nodes[0].box.intersect(origin, invDir, r.tMin, r.tMax, tRoot)) return closest;
+    stack[stackSize++] = { 0, tRoot };
+
+    while (stackSize > 0) {
+        Entry entry = stack[--stackSize];
+        if (entry.tEntry > r.tMax) continue;
+
+        const Node& node = nodes[entry.node];
+        if (node.count > 0) {
+            for (uint32_t i = node.offset; i < node.offset + node.count; i++)
+                prims[i]->intersectClosest(r, closest);
+            continue;
+        }
+
+        Scalar tLeft = 0, tRight = 0;
+        bool hitLeft = nodes[node.offset].box.intersect(origin, invDir, r.tMin, r.tMax, tLeft);
+        bool hitRight = nodes[node.offset + 1].box.intersect(origin, invDir, r.tMin, r.tMax, tRight);
+
+        // Push the further child first, so the nearer one is popped next.
+        if (hitLeft && hitRight) {
+            if (tLeft <= tRight) {
+                stack[stackSize++] = { node.offset + 1, tRight };
+                stack[stackSize++] = { node.offset, tLeft };
+            } else {
+                stack[stackSize++] = { node.offset, tLeft };
+                stack[stackSize++] = { node.offset + 1, tRight };
+            }
+        } else if (hitLeft) {
+            stack[stackSize++] = { node.offset, tLeft };
+        } else if (hitRight) {
+            stack[stackSize++] = { node.offset + 1, tRight };
+        }
+    }
+
+    return closest;
+}
@@ -1,43 +1,103 @@
 #include <render/Ray.h>
 #include <render/Geometry.h>
+#include <render/RenderStats.h>
 
-RT::IntersectionDetail RT::Intersection::fillDetail(const Intersection& i, Ray r, Intersections& isections) {
+namespace {
+    // The objects a ray is currently inside of, innermost last.
+    // A ray is rarely inside more than a few objects at once, so the stack lives inline; only pathological nesting reaches the heap.
+    struct MediaStack {
+        static constexpr size_t inlineCapacity = 16;
+
+        Geo* inlineMedia[inlineCapacity];
+        std::vector<Geo*> spilled;
+        Geo** media = inlineMedia;
+        size_t capacity = inlineCapacity;
+        size_t size = 0;
+
+        // The refractive index of the innermost object, or of empty space if there isn't one.
+        [[nodiscard]] Scalar innermostIndex() const {
+            return size == 0 ? 1 : media[size - 1]->material.refractiveIndex;
+        }
+
+        // Leave the object if the ray is inside it, or enter it if not.
+        // Most surfaces crossed are the innermost one, so search from the top down.
+        void cross(Geo* object) {
+            for (size_t idx = size; idx-- > 0;) {
+                if (media[idx] == object) {
+                    std::copy(media + idx + 1, media + size, media + idx);
+                    size--;
+                    return;
+                }
+            }
+
+            if (size == capacity) spill();
+            media[size++] = object;
+        }
+
+        void spill() {
+            if (media == inlineMedia)
+                spilled.assign(inlineMedia, inlineMedia + size);
+            spilled.resize(capacity * 2);
+            media = spilled.data();
+            capacity *= 2;
+        }
+    };
+
+    // Walk the sorted intersections up to the hit, tracking which objects the ray is inside, to find the
+    // refractive index on the incoming (n1) and outgoing (n2) side of the hit.
+    void refractiveIndices(const RT::Intersection& hit, RT::Intersections& isections, Scalar& n1, Scalar& n2) {
+        MediaStack media;
+        for (const RT::Intersection& i : isections) {
+            if (i == hit) {
+                RenderStats::inside(media.size);
+                n1 = media.innermostIndex();
+                media.cross(i.object);
+                n2 = media.innermostIndex();
+                return;
+            }
+
+            media.cross(i.object);
+        }
+    }
+}
+
+unsigned RT::Intersection::detailNeeds() const {
+    unsigned needs = NeedsShading;
+    if (object->material.reflectivity > 0) needs |= NeedsReflection;
+    if (object->material.transparency > 0) needs |= NeedsRefraction;
+    return needs;
+}
+
+RT::IntersectionDetail RT::Intersection::fillDetail(const Intersection& i, Ray r, Intersections& isections, unsigned needs) {
+    RenderStats::count(RenderStats::DetailFills);
     Point hitPos = Ray::position(r, i.time);
     Vector hitNormal = i.object->normalAt(hitPos);
     Vector eyeDir = -r.direction;
-    Vector reflectv = r.direction.reflect(hitNormal);
+    Vector reflectv { 0, 0, 0 };
+    if (needs & NeedsReflection)
+        reflectv = r.direction.reflect(hitNormal);
 
     bool inside = (hitNormal * eyeDir) < 0;
     if (inside) {
         hitNormal = -hitNormal;
     }
 
-    Point bumpPoint = Point(hitPos + hitNormal * 0.001);
-    Point underPoint = Point(hitPos - hitNormal * 0.001);
-
-    double n1 = 1;
-    double n2 = 1;
-
-    std::vector<Geo*> containers;
-    containers.reserve(isections.size);
-    for (size_t idx = 0; idx < isections.size; idx++) {
-        if (isections[idx] == i)
-            if (!containers.empty())
-                n1 = containers.back()->material.refractiveIndex;
-
-        auto pos = std::find(containers.begin(), containers.end(), isections[idx].object);
-        if (pos != containers.end()) {
-            containers.erase(pos);
-        } else
-            containers.emplace_back(isections[idx].object);
-
-        if (isections[idx] == i) {
-            if (!containers.empty())
-                n2 = containers.back()->material.refractiveIndex;
-            break;
-        }
-    }
+    // Nudge the hit off the surface either way, far enough to clear the rounding error in its position.
+    // That error comes from both where the ray started and how far it travelled.
+    Scalar scale = std::max({ std::abs(hitPos.x), std::abs(hitPos.y), std::abs(hitPos.z),
+                              std::abs(r.origin.x), std::abs(r.origin.y), std::abs(r.origin.z) });
+    Scalar offset = Precision::surfaceOffset(scale);
+    Point bumpPoint = Point(hitPos + hitNormal * offset);
+    Point underPoint { 0, 0, 0 };
 
+    // Only surfaces that let light through refract it, so only they need to know what's on either side.
+    Scalar n1 = 1;
+    Scalar n2 = 1;
+    if (needs & NeedsRefraction) {
+        underPoint = Point(hitPos - hitNormal * offset);
+        if (i.object->material.transparency > 0)
+            refractiveIndices(i, isections, n1, n2);
+    }
 
     return { i.time, *i.object, hitPos, bumpPoint, underPoint, eyeDir, hitNormal, reflectv, n1, n2, inside };
-}
\ No newline at end of file
+}
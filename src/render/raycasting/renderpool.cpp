@@ -0,0 +1,116 @@
+#include <render/RenderPool.h>
+
+RenderPool::RenderPool(size_t threadCount) : scheduler(threadCount) {
+    for (size_t i = 0; i < scheduler.workerCount(); i++)
+        threads.emplace_back(&RenderPool::work, this, i);
+}
+
+RenderPool::~RenderPool() {
+    {
+        std::unique_lock<std::mutex> guard(lock);
+        supersede(guard);
+        stopping = true;
+    }
+    wake.notify_all();
+
+    for (std::thread& t : threads)
+        t.join();
+}
+
+uint64_t RenderPool::submit(const std::vector<Tile>& tiles, Job next) {
+    return submit(std::vector<std::vector<Tile>> { tiles }, std::move(next));
+}
+
+uint64_t RenderPool::submit(std::vector<std::vector<Tile>> frame, Job next) {
+    uint64_t submitted;
+    {
+        std::unique_lock<std::mutex> guard(lock);
+        supersede(guard);
+
+        // Nobody is touching the scheduler now, so it's safe to deal it the new frame.
+        submitted = generation.load(std::memory_order_relaxed);
+        passes = std::move(frame);
+        job = std::move(next);
+        passesDone = 0;
+        advance();
+    }
+    return submitted;
+}
+
+void RenderPool::cancel() {
+    std::unique_lock<std::mutex> guard(lock);
+    supersede(guard);
+}
+
+void RenderPool::wait(uint64_t frame) {
+    std::unique_lock<std::mutex> guard(lock);
+    settled.wait(guard, [&] { return finished(frame) || (!current(frame) && busy == 0); });
+}
+
+void RenderPool::supersede(std::unique_lock<std::mutex>& guard) {
+    generation.fetch_add(1, std::memory_order_relaxed);
+    open = false;
+    settled.wait(guard, [&] { return busy == 0; });
+}
+
+void RenderPool::advance() {
+    // An empty pass has nothing to wait for.
+    while (passesDone < passes.size() && passes[passesDone].empty())
+        passesDone++;
+
+    if (passesDone == passes.size()) {
+        open = false;
+        completed.store(generation.load(std::memory_order_relaxed), std::memory_order_release);
+        settled.notify_all();
+        return;
+    }
+
+    // Publish the pass before dealing it. Workers still looking for tiles can take one as soon as it's dealt, and they
+    // need to see which pass it's from and count it off.
+    pass.store(passesDone, std::memory_order_release);
+    remaining = passes[passesDone].size();
+    scheduler.deal(passes[passesDone]);
+    open = true;
+    wake.notify_all();
+}
+
+void RenderPool::work(size_t self) {
+    std::unique_lock<std::mutex> guard(lock);
+    while (true) {
+        wake.wait(guard, [&] { return stopping || open; });
+        if (stopping) return;
+
+        uint64_t frame = generation.load(std::memory_order_relaxed);
+        busy++;
+        guard.unlock();
+
+        Tile tile {};
+        bool stolen = false;
+        size_t dealt = 0;
+        while (current(frame)) {
+            dealt = pass.load(std::memory_order_acquire);
+            if (!scheduler.next(self, tile, stolen)) break;
+
+            // Taking the tile synchronized with the deal, and the pass can't move on until this tile is done,
+            // so this is the pass the tile came from.
+            job(tile, frame, pass.load(std::memory_order_acquire));
+
+            // A superseded tile may have been left half done, so it doesn't count towards finishing the pass.
+            if (current(frame) && remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                guard.lock();
+                if (current(frame)) {
+                    passesDone++;
+                    advance();
+                }
+                guard.unlock();
+            }
+        }
+
+        guard.lock();
+        // Whoever finds the pass empty first closes it, so the others go back to sleep rather than spinning.
+        // If the next pass was dealt in the meantime, it's left open.
+        if (current(frame) && pass.load(std::memory_order_relaxed) == dealt) open = false;
+        busy--;
+        settled.notify_all();
+    }
+}
@@ -0,0 +1,96 @@
+#include <render/Scheduler.h>
+#include <algorithm>
+#include <utility>
+
+std::vector<Tile> TileScheduler::tile(int fromX, int fromY, int toX, int toY, int tileSize) {
+    std::vector<Tile> tiles;
+    if (toX <= fromX || toY <= fromY || tileSize <= 0) return tiles;
+
+    uint32_t columns = (toX - fromX + tileSize - 1) / tileSize;
+    uint32_t rows = (toY - fromY + tileSize - 1) / tileSize;
+    uint32_t side = 1;
+    while (side < columns || side < rows) side *= 2;
+
+    std::vector<std::pair<uint64_t, Tile>> ordered;
+    ordered.reserve((size_t) columns * rows);
+    for (uint32_t row = 0; row < rows; row++) {
+        for (uint32_t column = 0; column < columns; column++) {
+            int x = fromX + (int) column * tileSize;
+            int y = fromY + (int) row * tileSize;
+            ordered.emplace_back(hilbertIndex(side, column, row), Tile { x, y, std::min(x + tileSize, toX), std::min(y + tileSize, toY) });
+        }
+    }
+
+    std::sort(ordered.begin(), ordered.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+
+    tiles.reserve(ordered.size());
+    for (const auto& entry : ordered)
+        tiles.emplace_back(entry.second);
+    return tiles;
+}
+
+uint64_t TileScheduler::hilbertIndex(uint32_t side, uint32_t x, uint32_t y) {
+    uint64_t index = 0;
+    for (uint32_t s = side / 2; s > 0; s /= 2) {
+        uint32_t rx = (x & s) > 0;
+        uint32_t ry = (y & s) > 0;
+        index += (uint64_t) s * s * ((3 * rx) ^ ry);
+
+        // Rotate the quadrant, so that the curve through it joins up with its neighbours.
+        if (ry == 0) {
+            if (rx == 1) {
+                x = side - 1 - x;
+                y = side - 1 - y;
+            }
+            std::swap(x, y);
+        }
+    }
+    return index;
+}
+
+void TileScheduler::deal(const std::vector<Tile>& tiles) {
+    size_t count = workers.size();
+    for (size_t i = 0; i < count; i++) {
+        Worker& w = workers[i];
+        std::lock_guard<std::mutex> guard(w.lock);
+        w.tiles.assign(tiles.begin() + (ptrdiff_t) (tiles.size() * i / count), tiles.begin() + (ptrdiff_t) (tiles.size() * (i + 1) / count));
+        w.head = 0;
+        w.tail = w.tiles.size();
+        w.stats = WorkerStats();
+    }
+}
+
+bool TileScheduler::next(size_t worker, Tile& out, bool& stolen) {
+    {
+        Worker& self = workers[worker];
+        std::lock_guard<std::mutex> guard(self.lock);
+        if (self.head < self.tail) {
+            out = self.tiles[self.head++];
+            stolen = false;
+            return true;
+        }
+    }
+
+    // Try everyone else in turn, starting from our neighbour so that thieves spread out over the victims.
+    for (size_t offset = 1; offset < workers.size(); offset++) {
+        Worker& victim = workers[(worker + offset) % workers.size()];
+        std::lock_guard<std::mutex> guard(victim.lock);
+        if (victim.head < victim.tail) {
+            out = victim.tiles[--victim.tail];
+            stolen = true;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+std::vector<WorkerStats> TileScheduler::stats() const {
+    std::vector<WorkerStats> out;
+    out.reserve(workers.size());
+    for (const Worker& w : workers) {
+        std::lock_guard<std::mutex> guard(w.lock);
+        out.emplace_back(w.stats);
+    }
+    return out;
+}
@@ -0,0 +1,196 @@
+#include <view/Scene.h>
+#include <core/Trace.h>
+#include <cstdint>
+
+// The benchmark scenes. They're built straight into the scene's storage, as a loaded scene file would be, so that the
+// numbers measured on them are the numbers a real scene would get.
+
+namespace {
+    // A pseudo-random stream that gives the same numbers with every compiler and standard library.
+    // (std::uniform_real_distribution doesn't; its algorithm is left to the library.)
+    struct Random {
+        uint64_t state;
+
+        explicit Random(uint64_t seed) : state(seed) { }
+
+        // splitmix64
+        uint64_t next() {
+            uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+            return z ^ (z >> 31);
+        }
+
+        // Uniform in [from, to).
+        Scalar between(Scalar from, Scalar to) {
+            double unit = (double) (next() >> 11) * (1.0 / 9007199254740992.0);
+            return from + (Scalar) unit * (to - from);
+        }
+    };
+
+    constexpr uint64_t seed = 0xB0C4CE5;
+    const uint64_t sweepCounts[] = { 10, 100, 1000, 10000, 100000, 1000000 };
+
+    Sphere& sphere(Scene& scene, const Mat4& transform) {
+        Sphere& s = scene.owned.spheres.add();
+        s.setMatrix(transform);
+        return s;
+    }
+
+    Plane& plane(Scene& scene, const Mat4& transform) {
+        Plane& p = scene.owned.planes.add();
+        p.setMatrix(transform);
+        return p;
+    }
+
+    // Hand every object in the scene's storage to the world, planes first.
+    void finish(Scene& scene, const PointLight& light) {
+        std::vector<Geo*> objects;
+        for (auto& block : scene.owned.planes.blocks)
+            for (Plane& p : block) objects.push_back(&p);
+        for (auto& block : scene.owned.spheres.blocks)
+            for (Sphere& s : block) objects.push_back(&s);
+
+        scene.world = World();
+        scene.world.lightSource = light;
+        scene.world.addObjects(objects.data(), objects.size());
+    }
+
+    void diffuseSpheres(Scene& scene) {
+        Random random(seed);
+        Plane& floor = plane(scene, Mat4::identity());
+        floor.material.specular = 0;
+
+        for (int z = 0; z < 20; z++) {
+            for (int x = 0; x < 20; x++) {
+                Scalar radius = random.between(0.3, 0.6);
+                Sphere& s = sphere(scene, Mat4::translation(x * 1.5 - 14.25, radius, z * 1.5) * Mat4::scaling(radius, radius, radius));
+                s.material.color = Color(random.between(0.2, 1), random.between(0.2, 1), random.between(0.2, 1));
+                s.material.specular = 0.1;
+            }
+        }
+
+        scene.from = { 0, 8, -12 };
+        scene.to = { 0, 0, 12 };
+        finish(scene, PointLight({ -20, 30, -20 }, { 1, 1, 1 }));
+    }
+
+    void mirrors(Scene& scene) {
+        // Two mirrors facing each other across the hall, and one behind the camera; a floor to stand the spheres on.
+        for (Mat4 wall : { Mat4::translation(-4, 0, 0) * Mat4::rotation_z(M_PI / 2),
+                           Mat4::translation(4, 0, 0) * Mat4::rotation_z(M_PI / 2),
+                           Mat4::translation(0, 0, 10) * Mat4::rotation_x(M_PI / 2) }) {
+            Plane& mirror = plane(scene, wall);
+            mirror.material.color = Color(0.1, 0.1, 0.1);
+            mirror.material.diffuse = 0.1;
+            mirror.material.reflectivity = 0.9;
+        }
+        Plane& floor = plane(scene, Mat4::translation(0, -1, 0));
+        floor.material.color = Color(0.6, 0.6, 0.5);
+        floor.material.reflectivity = 0.2;
+
+        Color colors[] = { { 1, 0.2, 0.2 }, { 0.2, 1, 0.2 }, { 0.2, 0.2, 1 } };
+        for (int i = 0; i < 3; i++) {
+            Sphere& s = sphere(scene, Mat4::translation(i * 2 - 2, 0, 4 + i));
+            s.material.color = colors[i];
+            s.material.reflectivity = 0.3;
+        }
+
+        scene.from = { 0, 1, -3 };
+        scene.to = { 0.5, 0, 6 };
+        finish(scene, PointLight({ 0, 6, 0 }, { 1, 1, 1 }));
+    }
+
+    void nestedGlass(Scene& scene) {
+        auto checks = std::make_shared<Pattern::Checker>(Color(0.9, 0.9, 0.9), Color(0.1, 0.1, 0.1));
+        scene.owned.patterns.push_back(checks);
+        Plane& wall = plane(scene, Mat4::translation(0, 0, 6) * Mat4::rotation_x(M_PI / 2));
+        wall.material.pattern = checks.get();
+        wall.material.ambient = 0.8;
+        wall.material.diffuse = 0.2;
+
+        // Each shell alternates between glass and air, so every boundary bends the ray.
+        for (int i = 0; i < 4; i++) {
+            Scalar radius = 2 - i * 0.4;
+            Sphere& s = sphere(scene, Mat4::scaling(radius, radius, radius));
+            s.material.color = Color(0.1, 0.1, 0.1);
+            s.material.diffuse = 0.05;
+            s.material.transparency = 0.95;
+            s.material.reflectivity = 0.05;
+            s.material.refractiveIndex = i % 2 == 0 ? 1.5 : 1.0;
+        }
+
+        scene.from = { 0, 0, -6 };
+        finish(scene, PointLight({ -10, 10, -10 }, { 1, 1, 1 }));
+    }
+
+    void checkerPlanes(Scene& scene) {
+        auto checks = std::make_shared<Pattern::Checker>(Color(1, 1, 1), Color(0.2, 0.2, 0.6));
+        auto stripes = std::make_shared<Pattern::Stripe>(Color(0.9, 0.6, 0.3), Color(0.4, 0.2, 0.1));
+        stripes->setTransform(Mat4::scaling(0.5, 0.5, 0.5) * Mat4::rotation_y(M_PI / 4));
+        scene.owned.patterns.push_back(checks);
+        scene.owned.patterns.push_back(stripes);
+
+        Plane& floor = plane(scene, Mat4::identity());
+        floor.material.pattern = checks.get();
+        floor.material.reflectivity = 0.1;
+        for (Mat4 wall : { Mat4::translation(0, 0, 10) * Mat4::rotation_x(M_PI / 2),
+                           Mat4::translation(-10, 0, 0) * Mat4::rotation_z(M_PI / 2) }) {
+            Plane& p = plane(scene, wall);
+            p.material.pattern = stripes.get();
+            p.material.specular = 0;
+        }
+
+        Sphere& s = sphere(scene, Mat4::translation(0, 1, 3));
+        s.material.pattern = stripes.get();
+
+        scene.from = { 4, 3, -5 };
+        scene.to = { -1, 1, 4 };
+        finish(scene, PointLight({ 5, 10, -10 }, { 1, 1, 1 }));
+    }
+
+    void sweep(Scene& scene, uint64_t count) {
+        Random random(seed + count);
+        // The cube grows with the count, so that the spheres fill about the same fraction of it at every size.
+        Scalar side = 20 * std::cbrt((Scalar) count / 1000);
+        Scalar radius = 0.5;
+
+        for (uint64_t i = 0; i < count; i++) {
+            Mat4 at = Mat4::translation(random.between(-side, side), random.between(-side, side), random.between(-side, side));
+            Sphere& s = sphere(scene, at * Mat4::scaling(radius, radius, radius));
+            s.material.color = Color(random.between(0.2, 1), random.between(0.2, 1), random.between(0.2, 1));
+        }
+
+        scene.from = { 0, 0, -side * 3 };
+        finish(scene, PointLight({ -side * 2, side * 2, -side * 3 }, { 1, 1, 1 }));
+    }
+}
+
+std::vector<std::string> Scene::corpus() {
+    std::vector<std::string> names { "diffuse-spheres", "mirrors", "nested-glass", "checker-planes" };
+    for (uint64_t count : sweepCounts)
+        names.push_back("sweep-" + std::to_string(count));
+    return names;
+}
+
+bool Scene::corpusScene(const std::string& name, Scene& out) {
+    Trace::Scope trace("build scene");
+    Scene scene;
+    if (name == "diffuse-spheres") diffuseSpheres(scene);
+    else if (name == "mirrors") mirrors(scene);
+    else if (name == "nested-glass") nestedGlass(scene);
+    else if (name == "checker-planes") checkerPlanes(scene);
+    else {
+        bool found = false;
+        for (uint64_t count : sweepCounts) {
+            if (name == "sweep-" + std::to_string(count)) {
+                sweep(scene, count);
+                found = true;
+            }
+        }
+        if (!found) return false;
+    }
+
+    out = std::move(scene);
+    return true;
+}
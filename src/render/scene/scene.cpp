@@ -0,0 +1,351 @@
+#include <view/Scene.h>
+#include <core/Trace.h>
+#include <charconv>
+#include <cstring>
+#include <fstream>
+#include <string_view>
+#include <unordered_map>
+
+// Scene files are read a block at a time and split into lines in place; nothing is allocated per line or per object,
+// other than the objects themselves. They go into the scene's own arrays, and the world is given them all at once.
+
+namespace {
+    constexpr size_t blockSize = 1 << 20;
+
+    bool isSpace(char c) {
+        return c == ' ' || c == '\t' || c == '\r';
+    }
+
+    // Splits one line into whitespace separated words, stopping at a comment.
+    struct Words {
+        const char* at;
+        const char* end;
+
+        bool next(std::string_view& word) {
+            while (at < end && isSpace(*at)) at++;
+            if (at == end || *at == '#') return false;
+
+            const char* start = at;
+            while (at < end && !isSpace(*at) && *at != '#') at++;
+            word = std::string_view(start, at - start);
+            return true;
+        }
+    };
+
+    enum ObjectKind { SphereObject, PlaneObject };
+
+    class Parser {
+    public:
+        Parser(Scene& scene, std::string& error) : scene(scene), error(error) { }
+
+        // Parse one line; returns false if it was wrong.
+        bool line(const char* from, const char* to) {
+            lineNumber++;
+            Words words { from, to };
+            std::string_view keyword;
+            if (!words.next(keyword)) return true;
+
+            if (keyword == "sphere") return object(words, SphereObject);
+            if (keyword == "plane") return object(words, PlaneObject);
+            if (keyword == "material") return material(words);
+            if (keyword == "pattern") return pattern(words);
+            if (keyword == "light") return light(words);
+            if (keyword == "camera") return camera(words);
+            return fail("unknown statement", keyword);
+        }
+
+        // Hand every object to the world, in the order they were written.
+        void build() {
+            scene.world = World();
+            scene.world.lightSource = lightSource;
+            scene.world.addObjects(order.data(), order.size());
+        }
+
+        [[nodiscard]] size_t objectCount() const {
+            return order.size();
+        }
+
+    private:
+        Scene& scene;
+        std::string& error;
+        size_t lineNumber = 0;
+
+        PointLight lightSource { { 0, 0, 0 }, { 1, 1, 1 } };
+        // Every object, in the order written.
+        std::vector<Geo*> order;
+        std::unordered_map<std::string, Material> materials;
+        std::unordered_map<std::string, Pattern::Pattern*> patterns;
+        // Reused for looking names up, so that a lookup doesn't allocate.
+        std::string key;
+
+        bool fail(const char* message, std::string_view word = {}) {
+            error = "line " + std::to_string(lineNumber) + ": " + message;
+            if (!word.empty()) error += " '" + std::string(word) + "'";
+            return false;
+        }
+
+        bool number(Words& words, Scalar& out) {
+            std::string_view word;
+            if (!words.next(word)) return fail("expected a number");
+
+            double value;
+            auto result = std::from_chars(word.data(), word.data() + word.size(), value);
+            if (result.ec != std::errc() || result.ptr != word.data() + word.size()) return fail("expected a number, not", word);
+            out = (Scalar) value;
+            return true;
+        }
+
+        bool numbers(Words& words, Scalar* out, int count) {
+            for (int i = 0; i < count; i++)
+                if (!number(words, out[i])) return false;
+            return true;
+        }
+
+        template <typename T>
+        bool triple(Words& words, T& out) {
+            Scalar v[3];
+            if (!numbers(words, v, 3)) return false;
+            out = T(v[0], v[1], v[2]);
+            return true;
+        }
+
+        bool name(Words& words, std::string_view what) {
+            std::string_view word;
+            if (!words.next(word)) return fail("expected a name for the", what);
+            key.assign(word.data(), word.size());
+            return true;
+        }
+
+        static Scalar radians(Scalar degrees) {
+            return degrees * (Scalar) (M_PI / 180);
+        }
+
+        // If the word is a transform, read it and apply it after the ones before. Returns false if it was wrong.
+        bool transform(std::string_view word, Words& words, Mat4& m, bool& matched) {
+            matched = true;
+            Scalar v[6];
+            if (word == "translate") {
+                if (!numbers(words, v, 3)) return false;
+                m = Mat4::translation(v[0], v[1], v[2]) * m;
+            } else if (word == "scale") {
+                if (!numbers(words, v, 3)) return false;
+                m = Mat4::scaling(v[0], v[1], v[2]) * m;
+            } else if (word == "rotate-x") {
+                if (!number(words, v[0])) return false;
+                m = Mat4::rotation_x(radians(v[0])) * m;
+            } else if (word == "rotate-y") {
+                if (!number(words, v[0])) return false;
+                m = Mat4::rotation_y(radians(v[0])) * m;
+            } else if (word == "rotate-z") {
+                if (!number(words, v[0])) return false;
+                m = Mat4::rotation_z(radians(v[0])) * m;
+            } else if (word == "shear") {
+                if (!numbers(words, v, 6)) return false;
+                m = Mat4::shearing(v[0], v[1], v[2], v[3], v[4], v[5]) * m;
+            } else {
+                matched = false;
+            }
+            return true;
+        }
+
+        // If the word is a material setting, read it into the material. Returns false if it was wrong.
+        bool setting(std::string_view word, Words& words, Material& m, bool& matched) {
+            matched = true;
+            if (word == "color") return triple(words, m.color);
+            if (word == "ambient") return number(words, m.ambient);
+            if (word == "diffuse") return number(words, m.diffuse);
+            if (word == "specular") return number(words, m.specular);
+            if (word == "shininess") return number(words, m.shininess);
+            if (word == "reflectivity") return number(words, m.reflectivity);
+            if (word == "transparency") return number(words, m.transparency);
+            if (word == "refractiveIndex") return number(words, m.refractiveIndex);
+            if (word == "pattern") {
+                if (!name(words, "pattern")) return false;
+                auto found = patterns.find(key);
+                if (found == patterns.end()) return fail("no pattern called", key);
+                m.pattern = found->second;
+                return true;
+            }
+            if (word == "material") {
+                if (!name(words, "material")) return false;
+                auto found = materials.find(key);
+                if (found == materials.end()) return fail("no material called", key);
+                m = found->second;
+                return true;
+            }
+
+            matched = false;
+            return true;
+        }
+
+        bool object(Words& words, ObjectKind kind) {
+            Material m;
+            Mat4 t = Mat4::identity();
+
+            std::string_view word;
+            while (words.next(word)) {
+                bool matched;
+                if (!transform(word, words, t, matched)) return false;
+                if (matched) continue;
+                if (!setting(word, words, m, matched)) return false;
+                if (!matched) return fail("unknown setting", word);
+            }
+
+            Geo* geo;
+            if (kind == SphereObject) geo = &scene.owned.spheres.add();
+            else geo = &scene.owned.planes.add();
+            geo->material = m;
+            geo->setMatrix(t);
+            order.push_back(geo);
+            return true;
+        }
+
+        bool material(Words& words) {
+            if (!name(words, "material")) return false;
+            std::string named = key;
+            Material m;
+
+            std::string_view word;
+            while (words.next(word)) {
+                bool matched;
+                if (!setting(word, words, m, matched)) return false;
+                if (!matched) return fail("unknown material setting", word);
+            }
+
+            materials[named] = m;
+            return true;
+        }
+
+        bool pattern(Words& words) {
+            if (!name(words, "pattern")) return false;
+            std::string named = key;
+
+            std::string_view kind;
+            if (!words.next(kind)) return fail("expected a kind of pattern");
+            std::shared_ptr<Pattern::Pattern> p;
+            if (kind == "stripe") p = std::make_shared<Pattern::Stripe>(Color::white(), Color::black());
+            else if (kind == "checker") p = std::make_shared<Pattern::Checker>(Color::white(), Color::black());
+            else if (kind == "debug") p = std::make_shared<Pattern::Debug>();
+            else return fail("unknown kind of pattern", kind);
+
+            Mat4 t = Mat4::identity();
+            std::string_view word;
+            while (words.next(word)) {
+                bool matched;
+                if (!transform(word, words, t, matched)) return false;
+                if (matched) continue;
+
+                if (word == "a") {
+                    if (!triple(words, p->a)) return false;
+                } else if (word == "b") {
+                    if (!triple(words, p->b)) return false;
+                } else {
+                    return fail("unknown pattern setting", word);
+                }
+            }
+
+            p->setTransform(t);
+            scene.owned.patterns.push_back(p);
+            patterns[named] = p.get();
+            return true;
+        }
+
+        bool light(Words& words) {
+            std::string_view word;
+            while (words.next(word)) {
+                if (word == "position") {
+                    if (!triple(words, lightSource.position)) return false;
+                } else if (word == "intensity") {
+                    if (!triple(words, lightSource.intensity)) return false;
+                } else {
+                    return fail("unknown light setting", word);
+                }
+            }
+            return true;
+        }
+
+        bool camera(Words& words) {
+            std::string_view word;
+            while (words.next(word)) {
+                if (word == "from") {
+                    if (!triple(words, scene.from)) return false;
+                } else if (word == "to") {
+                    if (!triple(words, scene.to)) return false;
+                } else if (word == "up") {
+                    if (!triple(words, scene.up)) return false;
+                } else if (word == "fov") {
+                    Scalar degrees = 0;
+                    if (!number(words, degrees)) return false;
+                    scene.fieldOfView = radians(degrees);
+                } else {
+                    return fail("unknown camera setting", word);
+                }
+            }
+            return true;
+        }
+    };
+}
+
+bool Scene::load(std::istream& in, Scene& out, std::string& error, SceneLoadStats* stats) {
+    Trace::Scope trace("load scene");
+    auto parseStart = std::chrono::steady_clock::now();
+
+    Scene scene;
+    Parser parser(scene, error);
+
+    // Read a block at a time. Whatever's left after the last full line is moved to the front, to be finished by the
+    // next block; if a single line fills the whole buffer, the buffer grows.
+    std::vector<char> buffer(blockSize);
+    size_t held = 0;
+    bool finished = false;
+    while (!finished) {
+        if (held == buffer.size()) buffer.resize(buffer.size() * 2);
+        in.read(buffer.data() + held, (std::streamsize) (buffer.size() - held));
+        held += (size_t) in.gcount();
+        finished = !in;
+        if (finished && in.bad()) {
+            error = "couldn't read the scene";
+            return false;
+        }
+
+        const char* at = buffer.data();
+        const char* end = buffer.data() + held;
+        while (true) {
+            const char* newline = (const char*) std::memchr(at, '\n', end - at);
+            if (!newline) break;
+            if (!parser.line(at, newline)) return false;
+            at = newline + 1;
+        }
+
+        // The last line of the file needn't end with a newline.
+        if (finished && at < end) {
+            if (!parser.line(at, end)) return false;
+            at = end;
+        }
+
+        held = end - at;
+        std::memmove(buffer.data(), at, held);
+    }
+
+    auto buildStart = std::chrono::steady_clock::now();
+    parser.build();
+    auto buildEnd = std::chrono::steady_clock::now();
+
+    if (stats) {
+        stats->parse = buildStart - parseStart;
+        stats->build = buildEnd - buildStart;
+        stats->objects = parser.objectCount();
+    }
+
+    out = std::move(scene);
+    return true;
+}
+
+bool Scene::loadFile(const std::string& path, Scene& out, std::string& error, SceneLoadStats* stats) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        error = "couldn't open " + path;
+        return false;
+    }
+    return load(in, out, error, stats);
+}
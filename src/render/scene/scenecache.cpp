@@ -0,0 +1,438 @@
+#include <view/Scene.h>
+#include <core/Trace.h>
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <type_traits>
+#include <typeinfo>
+#include <unordered_map>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// The binary scene cache is a header followed by flat arrays: patterns, objects, BVH nodes, and the object indices of
+// the BVH's leaves and of the unbounded objects. Every record is fixed size, and holds matrices with their inverses
+// already worked out, so loading is a matter of copying records into objects; nothing is parsed or inverted, and the
+// BVH is used as it was built.
+//
+// Objects have vtables and patterns are pointed to, so the records can't be used as objects right where they're mapped.
+
+namespace {
+    constexpr char cacheMagic[8] = { 'B', 'N', 'C', 'S', 'C', 'E', 'N', 'E' };
+    // Bump whenever the layout of anything below changes.
+    constexpr uint32_t cacheVersion = 1;
+    // Written as is, so a cache from a machine of the other endianness reads back differently.
+    constexpr uint32_t byteOrderMark = 0x01020304;
+
+    enum PatternKind : uint32_t { PlainPattern, StripePattern, CheckerPattern, DebugPattern };
+    enum GeoKind : uint32_t { SphereGeo, PlaneGeo };
+
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t byteOrder;
+        uint32_t scalarSize;
+        uint32_t hasAccel;
+        // The size and modification time of the source file, when the cache was written.
+        uint64_t sourceSize;
+        int64_t sourceTime;
+        uint64_t patternCount;
+        uint64_t objectCount;
+        uint64_t nodeCount;
+        uint64_t primCount;
+        uint64_t unboundedCount;
+        Scalar from[3], to[3], up[3];
+        Scalar fieldOfView;
+        Scalar lightPosition[3], lightIntensity[3];
+    };
+
+    struct PatternRecord {
+        uint32_t kind;
+        uint32_t unused;
+        Scalar a[3], b[3];
+        Scalar transform[16], inverse[16];
+    };
+
+    struct ObjectRecord {
+        uint32_t kind;
+        // Index into the patterns, or -1 for none.
+        int32_t pattern;
+        Scalar transform[16], inverse[16], normal[16];
+        Scalar color[3];
+        Scalar ambient, diffuse, specular, shininess, reflectivity, transparency, refractiveIndex;
+    };
+
+    static_assert(std::is_trivially_copyable<BVH::Node>::value, "BVH nodes are written to the cache as they are");
+    static_assert(sizeof(Header) % 8 == 0 && sizeof(PatternRecord) % 8 == 0 && sizeof(ObjectRecord) % 8 == 0 && sizeof(BVH::Node) % 8 == 0,
+                  "Every array in the cache has to start aligned");
+
+    size_t cacheSize(const Header& h) {
+        return sizeof(Header) + h.patternCount * sizeof(PatternRecord) + h.objectCount * sizeof(ObjectRecord) +
+               h.nodeCount * sizeof(BVH::Node) + (h.primCount + h.unboundedCount) * sizeof(uint32_t);
+    }
+
+    // What the source file is now, to tell whether a cache of it is stale.
+    bool stamp(const std::string& source, uint64_t& size, int64_t& time) {
+        std::error_code ec;
+        size = std::filesystem::file_size(source, ec);
+        if (ec) return false;
+        time = (int64_t) std::filesystem::last_write_time(source, ec).time_since_epoch().count();
+        return !ec;
+    }
+
+    template <typename T>
+    void put(Scalar* to, const T& t) {
+        to[0] = t.x; to[1] = t.y; to[2] = t.z;
+    }
+
+    template <typename T>
+    T get(const Scalar* from) {
+        return T(from[0], from[1], from[2]);
+    }
+
+    // A whole file, mapped read-only into memory for as long as this lives.
+    class MappedFile {
+    public:
+        explicit MappedFile(const std::string& path) {
+#ifdef _WIN32
+            file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+            if (file == INVALID_HANDLE_VALUE) return;
+            LARGE_INTEGER length;
+            if (!GetFileSizeEx(file, &length) || length.QuadPart == 0) return;
+            mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (!mapping) return;
+            data = (const char*) MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            if (data) size = (size_t) length.QuadPart;
+#else
+            int fd = open(path.c_str(), O_RDONLY);
+            if (fd < 0) return;
+            struct stat info {};
+            if (fstat(fd, &info) == 0 && info.st_size > 0) {
+                void* mapped = mmap(nullptr, (size_t) info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (mapped != MAP_FAILED) {
+                    data = (const char*) mapped;
+                    size = (size_t) info.st_size;
+                }
+            }
+            close(fd);
+#endif
+        }
+
+        ~MappedFile() {
+#ifdef _WIN32
+            if (data) UnmapViewOfFile(data);
+            if (mapping) CloseHandle(mapping);
+            if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+#else
+            if (data) munmap((void*) data, size);
+#endif
+        }
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        const char* data = nullptr;
+        size_t size = 0;
+
+    private:
+#ifdef _WIN32
+        HANDLE file = INVALID_HANDLE_VALUE;
+        HANDLE mapping = nullptr;
+#endif
+    };
+}
+
+bool Scene::saveCache(const Scene& scene, const std::string& cache, const std::string& source, std::string& error) {
+    Trace::Scope trace("save scene cache");
+    const World& w = scene.world;
+
+    Header h {};
+    std::memcpy(h.magic, cacheMagic, sizeof(cacheMagic));
+    h.version = cacheVersion;
+    h.byteOrder = byteOrderMark;
+    h.scalarSize = sizeof(Scalar);
+    if (!stamp(source, h.sourceSize, h.sourceTime)) {
+        error = "couldn't read the time of " + source;
+        return false;
+    }
+    put(h.from, scene.from);
+    put(h.to, scene.to);
+    put(h.up, scene.up);
+    h.fieldOfView = scene.fieldOfView;
+    put(h.lightPosition, w.lightSource.position);
+    put(h.lightIntensity, w.lightSource.intensity);
+
+    // Patterns are shared between objects, so each is written once and referred to by index.
+    std::vector<PatternRecord> patterns;
+    std::unordered_map<const Pattern::Pattern*, int32_t> patternIndex;
+    std::vector<ObjectRecord> objects(w.numObjs);
+    std::unordered_map<const Geo*, uint32_t> objectIndex;
+    objectIndex.reserve(w.numObjs);
+
+    for (size_t i = 0; i < w.numObjs; i++) {
+        Geo* geo = w.objects[i];
+        ObjectRecord& o = objects[i];
+        objectIndex[geo] = (uint32_t) i;
+
+        if (dynamic_cast<Sphere*>(geo)) o.kind = SphereGeo;
+        else if (dynamic_cast<Plane*>(geo)) o.kind = PlaneGeo;
+        else {
+            error = std::string("can't cache geometry of kind ") + geo->getName();
+            return false;
+        }
+
+        std::memcpy(o.transform, geo->transform.data, sizeof(o.transform));
+        std::memcpy(o.inverse, geo->inverseTransform.data, sizeof(o.inverse));
+        std::memcpy(o.normal, geo->normalTransform.data, sizeof(o.normal));
+
+        const Material& m = geo->material;
+        put(o.color, m.color);
+        o.ambient = m.ambient;
+        o.diffuse = m.diffuse;
+        o.specular = m.specular;
+        o.shininess = m.shininess;
+        o.reflectivity = m.reflectivity;
+        o.transparency = m.transparency;
+        o.refractiveIndex = m.refractiveIndex;
+        o.pattern = -1;
+
+        if (m.pattern) {
+            auto found = patternIndex.find(m.pattern);
+            if (found != patternIndex.end()) {
+                o.pattern = found->second;
+                continue;
+            }
+
+            PatternRecord p {};
+            if (dynamic_cast<Pattern::Stripe*>(m.pattern)) p.kind = StripePattern;
+            else if (dynamic_cast<Pattern::Checker*>(m.pattern)) p.kind = CheckerPattern;
+            else if (dynamic_cast<Pattern::Debug*>(m.pattern)) p.kind = DebugPattern;
+            else if (typeid(*m.pattern) == typeid(Pattern::Pattern)) p.kind = PlainPattern;
+            else {
+                error = "can't cache a custom pattern";
+                return false;
+            }
+            put(p.a, m.pattern->a);
+            put(p.b, m.pattern->b);
+            std::memcpy(p.transform, m.pattern->transform.data, sizeof(p.transform));
+            std::memcpy(p.inverse, m.pattern->inverseTransform.data, sizeof(p.inverse));
+
+            o.pattern = (int32_t) patterns.size();
+            patternIndex[m.pattern] = o.pattern;
+            patterns.push_back(p);
+        }
+    }
+
+    std::vector<uint32_t> prims, unbounded;
+    h.hasAccel = !w.accel.empty() || w.numObjs == 0;
+    if (h.hasAccel) {
+        for (const Geo* geo : w.accel.prims) prims.push_back(objectIndex.at(geo));
+        for (const Geo* geo : w.accel.unbounded) unbounded.push_back(objectIndex.at(geo));
+        h.nodeCount = w.accel.nodes.size();
+    }
+    h.patternCount = patterns.size();
+    h.objectCount = objects.size();
+    h.primCount = prims.size();
+    h.unboundedCount = unbounded.size();
+
+    // Written beside the cache and moved over it, so a reader never sees half a cache.
+    std::string partial = cache + ".partial";
+    {
+        std::ofstream out(partial, std::ios::binary | std::ios::trunc);
+        out.write((const char*) &h, sizeof(h));
+        out.write((const char*) patterns.data(), (std::streamsize) (patterns.size() * sizeof(PatternRecord)));
+        out.write((const char*) objects.data(), (std::streamsize) (objects.size() * sizeof(ObjectRecord)));
+        if (h.hasAccel) out.write((const char*) w.accel.nodes.data(), (std::streamsize) (h.nodeCount * sizeof(BVH::Node)));
+        out.write((const char*) prims.data(), (std::streamsize) (prims.size() * sizeof(uint32_t)));
+        out.write((const char*) unbounded.data(), (std::streamsize) (unbounded.size() * sizeof(uint32_t)));
+        if (!out) {
+            error = "couldn't write " + partial;
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(partial, cache, ec);
+    if (ec) {
+        error = "couldn't replace " + cache + ": " + ec.message();
+        return false;
+    }
+    return true;
+}
+
+bool Scene::loadCache(const std::string& cache, const std::string& source, Scene& out, std::string& error, SceneLoadStats* stats) {
+    Trace::Scope trace("load scene cache");
+    auto parseStart = std::chrono::steady_clock::now();
+
+    MappedFile file(cache);
+    if (!file.data || file.size < sizeof(Header)) {
+        error = "no cache at " + cache;
+        return false;
+    }
+
+    Header h {};
+    std::memcpy(&h, file.data, sizeof(h));
+    if (std::memcmp(h.magic, cacheMagic, sizeof(cacheMagic)) != 0 || h.version != cacheVersion ||
+        h.byteOrder != byteOrderMark || h.scalarSize != sizeof(Scalar)) {
+        error = cache + " is from another version or build";
+        return false;
+    }
+
+    uint64_t sourceSize;
+    int64_t sourceTime;
+    if (!stamp(source, sourceSize, sourceTime) || sourceSize != h.sourceSize || sourceTime != h.sourceTime) {
+        error = cache + " is stale";
+        return false;
+    }
+
+    // No count can be bigger than the file, which also keeps the size sum below from overflowing.
+    bool countsFit = h.patternCount <= file.size && h.objectCount <= file.size && h.nodeCount <= file.size &&
+                     h.primCount <= file.size && h.unboundedCount <= file.size;
+    if (!countsFit || h.objectCount > UINT32_MAX || h.primCount + h.unboundedCount > h.objectCount || cacheSize(h) != file.size) {
+        error = cache + " is damaged";
+        return false;
+    }
+
+    const char* at = file.data + sizeof(Header);
+    auto* patternRecords = (const PatternRecord*) at;
+    at += h.patternCount * sizeof(PatternRecord);
+    auto* objectRecords = (const ObjectRecord*) at;
+    at += h.objectCount * sizeof(ObjectRecord);
+    auto* nodes = (const BVH::Node*) at;
+    at += h.nodeCount * sizeof(BVH::Node);
+    auto* prims = (const uint32_t*) at;
+    auto* unbounded = prims + h.primCount;
+
+    // Check every reference before anything is built from them, so a damaged cache can't point outside itself.
+    for (uint64_t i = 0; i < h.patternCount; i++) {
+        if (patternRecords[i].kind > DebugPattern) {
+            error = cache + " is damaged";
+            return false;
+        }
+    }
+    for (uint64_t i = 0; i < h.objectCount; i++) {
+        const ObjectRecord& o = objectRecords[i];
+        if (o.kind > PlaneGeo || o.pattern < -1 || o.pattern >= (int64_t) h.patternCount) {
+            error = cache + " is damaged";
+            return false;
+        }
+    }
+    for (uint64_t i = 0; i < h.primCount + h.unboundedCount; i++) {
+        if (prims[i] >= h.objectCount) {
+            error = cache + " is damaged";
+            return false;
+        }
+    }
+    // Children come after their parents, so every walk down the tree ends, and the depth of each node is known by the
+    // time it's reached. The traversals keep their pending nodes on a fixed stack, which the tree mustn't outgrow.
+    std::vector<uint32_t> depth(h.nodeCount, 0);
+    for (uint64_t i = 0; i < h.nodeCount; i++) {
+        const BVH::Node& n = nodes[i];
+        bool fits = n.count > 0 ? (uint64_t) n.offset + n.count <= h.primCount
+                                : n.offset > i && (uint64_t) n.offset + 1 < h.nodeCount && depth[i] + 1 < BVH::stackDepth;
+        if (!fits) {
+            error = cache + " is damaged";
+            return false;
+        }
+        if (n.count == 0) {
+            depth[n.offset] = std::max(depth[n.offset], depth[i] + 1);
+            depth[n.offset + 1] = std::max(depth[n.offset + 1], depth[i] + 1);
+        }
+    }
+
+    Scene scene;
+    scene.from = get<Point>(h.from);
+    scene.to = get<Point>(h.to);
+    scene.up = get<Vector>(h.up);
+    scene.fieldOfView = h.fieldOfView;
+
+    std::vector<Pattern::Pattern*> patterns(h.patternCount);
+    for (uint64_t i = 0; i < h.patternCount; i++) {
+        const PatternRecord& p = patternRecords[i];
+        std::shared_ptr<Pattern::Pattern> made;
+        switch (p.kind) {
+            case StripePattern: made = std::make_shared<Pattern::Stripe>(get<Color>(p.a), get<Color>(p.b)); break;
+            case CheckerPattern: made = std::make_shared<Pattern::Checker>(get<Color>(p.a), get<Color>(p.b)); break;
+            case DebugPattern: made = std::make_shared<Pattern::Debug>(); break;
+            default: made = std::make_shared<Pattern::Pattern>(); break;
+        }
+        made->a = get<Color>(p.a);
+        made->b = get<Color>(p.b);
+        std::memcpy(made->transform.data, p.transform, sizeof(p.transform));
+        std::memcpy(made->inverseTransform.data, p.inverse, sizeof(p.inverse));
+        patterns[i] = made.get();
+        scene.owned.patterns.push_back(std::move(made));
+    }
+
+    std::vector<Geo*> objects(h.objectCount);
+    for (uint64_t i = 0; i < h.objectCount; i++) {
+        const ObjectRecord& o = objectRecords[i];
+        Geo* geo;
+        if (o.kind == SphereGeo) geo = &scene.owned.spheres.add();
+        else geo = &scene.owned.planes.add();
+
+        std::memcpy(geo->transform.data, o.transform, sizeof(o.transform));
+        std::memcpy(geo->inverseTransform.data, o.inverse, sizeof(o.inverse));
+        std::memcpy(geo->normalTransform.data, o.normal, sizeof(o.normal));
+        geo->center = geo->getCenter();
+
+        Material& m = geo->material;
+        m.color = get<Color>(o.color);
+        m.pattern = o.pattern < 0 ? nullptr : patterns[o.pattern];
+        m.ambient = o.ambient;
+        m.diffuse = o.diffuse;
+        m.specular = o.specular;
+        m.shininess = o.shininess;
+        m.reflectivity = o.reflectivity;
+        m.transparency = o.transparency;
+        m.refractiveIndex = o.refractiveIndex;
+        objects[i] = geo;
+    }
+
+    auto buildStart = std::chrono::steady_clock::now();
+    World& w = scene.world;
+    w.lightSource = PointLight(get<Point>(h.lightPosition), get<Color>(h.lightIntensity));
+    if (h.hasAccel) {
+        // The tree is taken as it was built; only its pointers need putting back.
+        w.objects = std::make_unique<Geo*[]>(h.objectCount);
+        std::copy(objects.begin(), objects.end(), w.objects.get());
+        w.numObjs = h.objectCount;
+        w.accel.nodes.assign(nodes, nodes + h.nodeCount);
+        w.accel.prims.resize(h.primCount);
+        for (uint64_t i = 0; i < h.primCount; i++) w.accel.prims[i] = objects[prims[i]];
+        w.accel.unbounded.resize(h.unboundedCount);
+        for (uint64_t i = 0; i < h.unboundedCount; i++) w.accel.unbounded[i] = objects[unbounded[i]];
+    } else {
+        w.addObjects(objects.data(), objects.size());
+    }
+    auto buildEnd = std::chrono::steady_clock::now();
+
+    if (stats) {
+        stats->parse = buildStart - parseStart;
+        stats->build = buildEnd - buildStart;
+        stats->objects = h.objectCount;
+        stats->cached = true;
+    }
+
+    out = std::move(scene);
+    return true;
+}
+
+bool Scene::loadFileCached(const std::string& path, Scene& out, std::string& error, SceneLoadStats* stats) {
+    std::string cache = cachePath(path);
+    if (loadCache(cache, path, out, error, stats)) return true;
+
+    if (!loadFile(path, out, error, stats)) return false;
+
+    // A cache that can't be written only costs the next run its head start.
+    std::string ignored;
+    saveCache(out, cache, path, ignored);
+    return true;
+}
@@ -0,0 +1,69 @@
+/***************
+ * THECURLE    *
+ *     BOUNCER *
+ ***************/
+
+#include <catch2/catch_test_macros.hpp>
+#include <render/Geometry.h>
+#include <view/World.h>
+#include <cstdlib>
+#include <new>
+
+using namespace RT;
+
+// Count every allocation made through the global operator new, per thread.
+// This replaces operator new for the whole test binary, which is harmless; it only counts.
+static thread_local size_t heapAllocations = 0;
+
+void* operator new(size_t size) {
+    heapAllocations++;
+    if (void* p = std::malloc(size == 0 ? 1 : size))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+SCENARIO("Intersecting the world does not allocate once warmed up") {
+    GIVEN("w: a row of 12 spheres behind each other, and a floor") {
+        std::vector<Sphere> spheres(12);
+        Plane floor;
+        floor.setMatrix(Matrix::translation(0, -2, 0));
+
+        World w;
+        w.addObjects({ &floor });
+        for (size_t i = 0; i < spheres.size(); i++) {
+            spheres[i].setMatrix(Matrix::translation(0, 0, (Scalar) i * 3));
+            w.addObjects({ &spheres[i] });
+        }
+
+        AND_GIVEN("rays through every sphere, and rays past them") {
+            std::vector<Ray> rays;
+            for (int i = 0; i < 100; i++)
+                rays.emplace_back(Point((Scalar) (i % 10) * 0.2 - 1, (Scalar) (i / 10) * 0.2 - 1, -5), Vector(0, -0.05, 1));
+
+            WHEN("every ray has been cast once") {
+                for (Ray& r : rays) w.intersect(r);
+
+                THEN("casting them again makes no heap allocations") {
+                    size_t before = heapAllocations;
+                    size_t hits = 0;
+                    for (Ray& r : rays) {
+                        Intersections xs = w.intersect(r);
+                        if (!xs.hit().isEmpty()) hits++;
+                    }
+                    size_t allocations = heapAllocations - before;
+
+                    REQUIRE(hits > 0);
+                    REQUIRE(allocations == 0);
+                }
+            }
+        }
+    }
+}
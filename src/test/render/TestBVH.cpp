@@ -0,0 +1,120 @@
+/***************
+ * THECURLE    *
+ *     BOUNCER *
+ ***************/
+
+#include <catch2/catch_test_macros.hpp>
+#include <render/BVH.h>
+#include <render/Geometry.h>
+#include <view/World.h>
+
+using namespace RT;
+
+SCENARIO("A sphere's bounds follow its transform") {
+    GIVEN("s: sphere() with transform: translation(5, 0, 0) * scaling(2, 2, 2)") {
+        Sphere s;
+        s.setMatrix(Matrix::translation(5, 0, 0) * Matrix::scaling(2, 2, 2));
+        WHEN("b: world_bounds(s)") {
+            Bounds b = s.worldBounds();
+            THEN("b.min = point(3, -2, -2)") {
+                REQUIRE(Point(b.min[0], b.min[1], b.min[2]) == Point(3, -2, -2));
+            }
+
+            AND_THEN("b.max = point(7, 2, 2)") {
+                REQUIRE(Point(b.max[0], b.max[1], b.max[2]) == Point(7, 2, 2));
+            }
+        }
+    }
+}
+
+SCENARIO("Planes are kept out of the hierarchy") {
+    GIVEN("p: plane()") {
+        Plane p;
+        AND_GIVEN("s: sphere()") {
+            Sphere s;
+            WHEN("bvh: build(p, s)") {
+                Geo* objects[] = { &p, &s };
+                BVH bvh;
+                bvh.build(objects, 2);
+
+                THEN("p is unbounded") {
+                    REQUIRE(bvh.unbounded.size() == 1);
+                    REQUIRE(bvh.unbounded[0] == &p);
+                }
+
+                AND_THEN("s is in the tree") {
+                    REQUIRE(bvh.prims.size() == 1);
+                    REQUIRE(bvh.prims[0] == &s);
+                }
+            }
+        }
+    }
+}
+
+SCENARIO("A ray that misses every bound produces no intersections") {
+    GIVEN("w: default_world()") {
+        World w = World::defaultWorld();
+        AND_GIVEN("r: ray( point(0, 5, -5), vector(0, 0, 1) )") {
+            Ray r { { 0, 5, -5 }, { 0, 0, 1 } };
+            WHEN("xs: intersect_world(w, r)") {
+                Intersections xs = w.intersect(r);
+                THEN("xs is empty") {
+                    REQUIRE(xs.size == 0);
+                }
+            }
+        }
+    }
+}
+
+SCENARIO("The hierarchy finds the same intersections as testing every object") {
+    GIVEN("a grid of 1000 spheres") {
+        std::vector<Sphere> spheres(1000);
+        std::vector<Geo*> objects;
+        for (size_t i = 0; i < spheres.size(); i++) {
+            spheres[i].setMatrix(Matrix::translation((double) (i % 10) * 3, (double) ((i / 10) % 10) * 3, (double) (i / 100) * 3) * Matrix::scaling(0.5, 1, 1.5));
+            objects.emplace_back(&spheres[i]);
+        }
+
+        WHEN("bvh: build(spheres)") {
+            BVH bvh;
+            bvh.build(objects.data(), objects.size());
+
+            THEN("every ray matches a linear scan") {
+                for (int i = 0; i < 100; i++) {
+                    Ray r { { -5, (double) i * 0.31, (double) i * 0.27 - 3 }, Vector(Vector(1, 0.1 * (i % 7), 0.05 * (i % 5)).normalize()) };
+
+                    std::vector<Intersection> linear;
+                    for (Geo* g : objects)
+                        g->intersect(r, linear);
+
+                    Intersections actual;
+                    bvh.intersect(r, actual);
+                    actual.sort();
+
+                    Intersections expected(linear.begin(), linear.end());
+
+                    REQUIRE(actual.size == expected.size);
+                    for (size_t idx = 0; idx < expected.size; idx++)
+                        REQUIRE(actual[idx].time == expected[idx].time);
+                }
+            }
+
+            AND_THEN("the closest hit matches the first hit of a linear scan") {
+                for (int i = 0; i < 100; i++) {
+                    Ray r { { (Scalar) i * 0.29 - 3, (Scalar) i * 0.31, 40 }, Vector(Vector(0.1 * (i % 3), -0.05 * (i % 4), -1).normalize()) };
+
+                    std::vector<Intersection> linear;
+                    for (Geo* g : objects)
+                        g->intersect(r, linear);
+                    Intersections expected(linear.begin(), linear.end());
+
+                    Ray front { r.origin, r.direction, 0, std::numeric_limits<Scalar>::infinity() };
+                    Intersection actual = bvh.closestHit(front);
+
+                    REQUIRE(actual.time == expected.hit().time);
+                    REQUIRE(actual.object == expected.hit().object);
+                }
+            }
+        }
+    }
+}
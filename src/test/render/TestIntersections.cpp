@@ -215,4 +215,109 @@ SCENARIO("Under point is offset below the surface") {
             }
         }
     }
-}
\ No newline at end of file
+}
+SCENARIO("The surface offset grows with the scale of the hit") {
+    GIVEN("a hit near the origin") {
+        THEN("the offset is epsilon") {
+            REQUIRE(Precision::surfaceOffset(1) == Precision::epsilon);
+        }
+    }
+
+    GIVEN("a hit far enough out that rounding error outgrows epsilon") {
+        Scalar scale = 2 * Precision::epsilon / Precision::relativeError;
+        THEN("the offset covers the rounding error") {
+            REQUIRE(Precision::surfaceOffset(scale) > Precision::epsilon);
+            REQUIRE(Precision::surfaceOffset(scale) >= scale * Precision::relativeError);
+        }
+    }
+}
+
+SCENARIO("Intersections beyond the inline capacity stay sorted") {
+    GIVEN("s: sphere()") {
+        Sphere s;
+        WHEN("xs: 40 intersections in descending order") {
+            Intersections xs;
+            for (int i = 40; i > 0; i--)
+                xs.emplace_back((Scalar) i, &s);
+            xs.sort();
+
+            THEN("xs.size = 40") {
+                REQUIRE(xs.size == 40);
+            }
+
+            AND_THEN("xs is in ascending order") {
+                for (size_t i = 0; i < xs.size; i++)
+                    REQUIRE(xs[i].time == (Scalar) (i + 1));
+            }
+        }
+    }
+}
+
+SCENARIO("Moving intersections empties the source") {
+    GIVEN("s: sphere()") {
+        Sphere s;
+        AND_GIVEN("xs: intersections(intersection(1, s), intersection(2, s))") {
+            Intersections xs { { 1, &s }, { 2, &s } };
+            WHEN("ys: move(xs)") {
+                Intersections ys = std::move(xs);
+
+                THEN("ys.size = 2") {
+                    REQUIRE(ys.size == 2);
+                    REQUIRE(ys[1].time == 2);
+                }
+
+                AND_THEN("xs.size = 0") {
+                    REQUIRE(xs.size == 0);
+                }
+            }
+        }
+    }
+}
+
+SCENARIO("Only the details a material needs are computed") {
+    GIVEN("r: ray(point(0, 0, -5), vector(0, 0, 1))") {
+        Ray r { { 0, 0, -5 }, { 0, 0, 1 } };
+        AND_GIVEN("shape: glass_sphere() with reflectivity 0") {
+            Sphere shape;
+            shape.material.transparency = 1;
+            shape.material.refractiveIndex = 1.5;
+            AND_GIVEN("i: intersection(4, shape)") {
+                Intersection i { 4, &shape };
+                Intersections xs { i };
+
+                THEN("i.detailNeeds() = NeedsRefraction") {
+                    REQUIRE(i.detailNeeds() == NeedsRefraction);
+                }
+
+                WHEN("comps: fillDetail(i, r, xs, NeedsShading)") {
+                    IntersectionDetail comps = Intersection::fillDetail(i, r, xs, NeedsShading);
+
+                    THEN("comps.overPoint.z < -1") {
+                        REQUIRE(comps.overPoint.z < -1);
+                    }
+
+                    AND_THEN("comps.reflectv = vector(0, 0, 0)") {
+                        REQUIRE(comps.reflectv == Vector(0, 0, 0));
+                    }
+
+                    AND_THEN("comps.n1 = 1 and comps.n2 = 1") {
+                        REQUIRE(comps.refractiveIdxIncoming == 1);
+                        REQUIRE(comps.refractiveIdxOutgoing == 1);
+                    }
+                }
+
+                WHEN("comps: fillDetail(i, r, xs, i.detailNeeds())") {
+                    IntersectionDetail comps = Intersection::fillDetail(i, r, xs, i.detailNeeds());
+
+                    THEN("comps.underPoint.z > -1") {
+                        REQUIRE(comps.underPoint.z > -1);
+                    }
+
+                    AND_THEN("comps.n2 = 1.5") {
+                        REQUIRE(comps.refractiveIdxOutgoing == 1.5);
+                    }
+                }
+            }
+        }
+    }
+}
@@ -172,4 +172,54 @@ SCENARIO("A sphere is behind a ray") {
             }
         }
     }
-}
\ No newline at end of file
+}
+
+SCENARIO("A ray's interval clips intersections") {
+    GIVEN("r: ray( point(0, 0, -5), vector(0, 0, 1) ) with interval [0, 5]") {
+        Ray r(Point(0, 0, -5), Vector(0, 0, 1), 0, 5);
+        AND_GIVEN("s: sphere()") {
+            Sphere s;
+            WHEN("xs: intersect(s, r)") {
+                Intersections xs;
+                s.intersect(r, xs);
+
+                THEN("xs.count = 1") {
+                    REQUIRE(xs.size == 1);
+                }
+
+                AND_THEN("xs[0] = 4") {
+                    REQUIRE(xs[0].time == 4);
+                }
+            }
+        }
+    }
+}
+
+SCENARIO("A closest-hit query shrinks the ray's interval") {
+    GIVEN("r: ray( point(0, 0, 0), vector(0, 0, 1) ) with interval [0, infinity]") {
+        Ray r(Point(0, 0, 0), Vector(0, 0, 1), 0, std::numeric_limits<Scalar>::infinity());
+        AND_GIVEN("s: sphere()") {
+            Sphere s;
+            WHEN("hit: intersect_closest(s, r)") {
+                Intersection hit;
+                bool found = s.intersectClosest(r, hit);
+
+                THEN("the exit is found, since the entry is behind the ray") {
+                    REQUIRE(found);
+                    REQUIRE(hit.time == 1);
+                }
+
+                AND_THEN("r.tMax = 1") {
+                    REQUIRE(r.tMax == 1);
+                }
+
+                AND_THEN("a second sphere further along is rejected") {
+                    Sphere further;
+                    further.setMatrix(Matrix::translation(0, 0, 5));
+                    REQUIRE(further.intersectClosest(r, hit) == false);
+                    REQUIRE(hit.time == 1);
+                }
+            }
+        }
+    }
+}
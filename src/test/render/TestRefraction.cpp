@@ -106,6 +106,72 @@ SCENARIO("Finding n1 and n2 at various intersections") {
     }
 }
 
+SCENARIO("Finding n1 and n2 inside more nested objects than the media stack holds inline") {
+    GIVEN("spheres: 20 concentric glass spheres of shrinking radius, with refractive indices 1.1, 1.2, ..., 3.0") {
+        std::vector<Sphere> spheres(20);
+        for (size_t i = 0; i < spheres.size(); i++) {
+            spheres[i].material.transparency = 1;
+            spheres[i].material.refractiveIndex = 1 + (Scalar) (i + 1) * 0.1;
+            spheres[i].setMatrix(Matrix::scaling(20 - (Scalar) i, 20 - (Scalar) i, 20 - (Scalar) i));
+        }
+
+        AND_GIVEN("r: ray( point(0, 0, -30), vector(0, 0, 1) )") {
+            Ray r { { 0, 0, -30 }, { 0, 0, 1 } };
+            AND_GIVEN("xs: every intersection of r with the spheres") {
+                std::vector<Intersection> sect;
+                for (Sphere& s : spheres)
+                    s.intersect(r, sect);
+                Intersections xs(sect.begin(), sect.end());
+
+                WHEN("detail: fillDetail(xs[19], r)") {
+                    IntersectionDetail detail = Intersection::fillDetail(xs[19], r, xs);
+                    THEN("detail.n1 = 2.9") {
+                        REQUIRE(safeCompare(detail.refractiveIdxIncoming, 2.9));
+                    }
+
+                    AND_THEN("detail.n2 = 3.0") {
+                        REQUIRE(safeCompare(detail.refractiveIdxOutgoing, 3.0));
+                    }
+                }
+
+                WHEN("detail: fillDetail(xs[21], r)") {
+                    IntersectionDetail detail = Intersection::fillDetail(xs[21], r, xs);
+                    THEN("detail.n1 = 2.9") {
+                        REQUIRE(safeCompare(detail.refractiveIdxIncoming, 2.9));
+                    }
+
+                    AND_THEN("detail.n2 = 2.8") {
+                        REQUIRE(safeCompare(detail.refractiveIdxOutgoing, 2.8));
+                    }
+                }
+            }
+        }
+    }
+}
+
+SCENARIO("n1 and n2 are not worked out for opaque surfaces") {
+    GIVEN("a: glass_sphere() with transform: scaling(2, 2, 2)") {
+        Sphere a = Sphere::glassSphere();
+        a.setMatrix(Matrix::scaling(2, 2, 2));
+        AND_GIVEN("b: sphere()") {
+            Sphere b;
+            AND_GIVEN("r: ray( point(0, 0, -4), vector(0, 0, 1) )") {
+                Ray r { { 0, 0, -4 }, { 0, 0, 1 } };
+                AND_GIVEN("xs: intersections(2:A, 3:B, 5:B, 6:A)") {
+                    Intersections xs { { 2, &a }, { 3, &b }, { 5, &b }, { 6, &a } };
+                    WHEN("detail: fillDetail(xs[1], r)") {
+                        IntersectionDetail detail = Intersection::fillDetail(xs[1], r, xs);
+                        THEN("detail.n1 = detail.n2 = 1") {
+                            REQUIRE(detail.refractiveIdxIncoming == 1);
+                            REQUIRE(detail.refractiveIdxOutgoing == 1);
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
 SCENARIO("Refracted color of an opaque surface") {
     GIVEN("w: default_world()") {
         World w = World::defaultWorld();
@@ -226,13 +292,13 @@ SCENARIO("Shade hit with transparency") {
         World w = World::defaultWorld();
         AND_GIVEN("floor: plane() with transform: translation(0, -1, 0) and transparency: 0.5 and refractiveIndex: 1.5") {
             Plane floor;
-            floor.transform = Matrix::translation(0, -1, 0);
+            floor.setMatrix(Matrix::translation(0, -1, 0));
             floor.material.transparency = 0.5;
             floor.material.refractiveIndex = 1.5;
             AND_GIVEN("floor is added to w") {
                 AND_GIVEN("ball: sphere() with color: (1, 0, 0) and ambient: 0.5 and transform: translation(0, -3.5, -0.5)") {
                     Sphere ball;
-                    ball.transform = Matrix::translation(0, -3.5, -0.5);
+                    ball.setMatrix(Matrix::translation(0, -3.5, -0.5));
                     ball.material.color = { 1, 0, 0 };
                     ball.material.ambient = 0.5;
                     AND_GIVEN("ball is added to w") {
@@ -243,8 +309,8 @@ SCENARIO("Shade hit with transparency") {
                                 Intersections xs { { std::sqrt(2), &floor } };
                                 WHEN("detail: prepareDetail(i, r, xs)") {
                                     IntersectionDetail detail = Intersection::fillDetail(xs[0], r, xs);
-                                    AND_WHEN("c: refractedColor(w, detail, 5)") {
-                                        Color c = Light::refracted(w, detail, 5);
+                                    AND_WHEN("c: shade_hit(w, detail, 5)") {
+                                        Color c = Light::shadeHit(w, detail, 5);
                                         THEN("c = color(0.93642, 0.68642, 0.68642)") {
                                             REQUIRE(c == Color(0.93642, 0.68642, 0.68642));
                                         }
@@ -0,0 +1,192 @@
+/***************
+ * THECURLE    *
+ *     BOUNCER *
+ ***************/
+
+#include <catch2/catch_test_macros.hpp>
+#include <render/Scheduler.h>
+#include <render/RenderPool.h>
+#include <atomic>
+#include <cstdlib>
+
+SCENARIO("Tiles cover the region exactly once") {
+    GIVEN("tiles: tile(3, 5, 100, 70, 16)") {
+        std::vector<Tile> tiles = TileScheduler::tile(3, 5, 100, 70, 16);
+
+        THEN("there are 7 * 5 tiles") {
+            REQUIRE(tiles.size() == 35);
+        }
+
+        AND_THEN("every pixel is in exactly one tile") {
+            std::vector<int> covered(97 * 65, 0);
+            for (const Tile& t : tiles)
+                for (int y = t.fromY; y < t.toY; y++)
+                    for (int x = t.fromX; x < t.toX; x++)
+                        covered[(y - 5) * 97 + (x - 3)]++;
+
+            for (int count : covered)
+                REQUIRE(count == 1);
+        }
+    }
+}
+
+SCENARIO("Tiles are in Hilbert order") {
+    GIVEN("tiles: tile(0, 0, 64, 64, 8)") {
+        std::vector<Tile> tiles = TileScheduler::tile(0, 0, 64, 64, 8);
+
+        THEN("each tile shares an edge with the one before it") {
+            for (size_t i = 1; i < tiles.size(); i++) {
+                int dx = std::abs(tiles[i].fromX - tiles[i - 1].fromX);
+                int dy = std::abs(tiles[i].fromY - tiles[i - 1].fromY);
+                REQUIRE(dx + dy == 8);
+            }
+        }
+
+        AND_THEN("the curve starts in the corner") {
+            REQUIRE(tiles.front() == Tile { 0, 0, 8, 8 });
+        }
+    }
+}
+
+SCENARIO("An idle worker steals from the back of another's run") {
+    GIVEN("scheduler: tile_scheduler(2) dealt 4 tiles") {
+        TileScheduler scheduler(2);
+        std::vector<Tile> tiles = TileScheduler::tile(0, 0, 4, 1, 1);
+        scheduler.deal(tiles);
+
+        Tile t {};
+        bool stolen = false;
+        WHEN("worker 1 takes its own two tiles") {
+            REQUIRE(scheduler.next(1, t, stolen));
+            REQUIRE(scheduler.next(1, t, stolen));
+
+            THEN("the next tile worker 1 takes is worker 0's last") {
+                REQUIRE(scheduler.next(1, t, stolen));
+                REQUIRE(stolen);
+                REQUIRE(t == tiles[1]);
+            }
+
+            AND_THEN("worker 0 still takes its own from the front") {
+                REQUIRE(scheduler.next(0, t, stolen));
+                REQUIRE_FALSE(stolen);
+                REQUIRE(t == tiles[0]);
+            }
+
+            AND_THEN("once both runs are empty there is no more work") {
+                REQUIRE(scheduler.next(1, t, stolen));
+                REQUIRE(scheduler.next(0, t, stolen));
+                REQUIRE_FALSE(scheduler.next(0, t, stolen));
+                REQUIRE_FALSE(scheduler.next(1, t, stolen));
+            }
+        }
+    }
+}
+
+SCENARIO("Running the scheduler renders every tile once") {
+    GIVEN("scheduler: tile_scheduler(4)") {
+        TileScheduler scheduler(4);
+        std::vector<Tile> tiles = TileScheduler::tile(0, 0, 200, 150);
+
+        WHEN("every tile is run") {
+            std::vector<std::atomic<int>> rendered(200 * 150);
+            scheduler.run(tiles, [&](const Tile& t) {
+                for (int y = t.fromY; y < t.toY; y++)
+                    for (int x = t.fromX; x < t.toX; x++)
+                        rendered[y * 200 + x]++;
+            });
+
+            THEN("every pixel was rendered once") {
+                for (std::atomic<int>& count : rendered)
+                    REQUIRE(count == 1);
+            }
+
+            AND_THEN("the workers' stats account for every tile") {
+                size_t total = 0;
+                for (const WorkerStats& w : scheduler.stats())
+                    total += w.tiles;
+                REQUIRE(total == tiles.size());
+            }
+        }
+    }
+}
+
+SCENARIO("A render pool renders every tile of a frame") {
+    GIVEN("pool: render_pool(3)") {
+        RenderPool pool(3);
+        std::vector<Tile> tiles = TileScheduler::tile(0, 0, 64, 64, 8);
+
+        WHEN("frame: pool.submit(tiles, count)") {
+            std::atomic<size_t> rendered { 0 };
+            uint64_t frame = pool.submit(tiles, [&](const Tile&, uint64_t, size_t) { rendered++; });
+            pool.wait(frame);
+
+            THEN("the frame is finished") {
+                REQUIRE(pool.finished(frame));
+            }
+
+            AND_THEN("every tile was rendered once") {
+                REQUIRE(rendered == tiles.size());
+            }
+        }
+    }
+}
+
+SCENARIO("Submitting a frame abandons the one in flight") {
+    GIVEN("pool: render_pool(2) with a frame that waits until it is superseded") {
+        RenderPool pool(2);
+        std::vector<Tile> tiles = TileScheduler::tile(0, 0, 64, 64, 8);
+
+        std::atomic<size_t> started { 0 };
+        uint64_t first = pool.submit(tiles, [&](const Tile&, uint64_t generation, size_t) {
+            started++;
+            while (pool.current(generation))
+                std::this_thread::yield();
+        });
+        while (started == 0)
+            std::this_thread::yield();
+
+        WHEN("second: pool.submit(tiles, count)") {
+            std::atomic<size_t> rendered { 0 };
+            uint64_t second = pool.submit(tiles, [&](const Tile&, uint64_t, size_t) { rendered++; });
+            pool.wait(second);
+
+            THEN("the first frame never finishes") {
+                REQUIRE_FALSE(pool.current(first));
+                REQUIRE_FALSE(pool.finished(first));
+                REQUIRE(started <= pool.threadCount());
+            }
+
+            AND_THEN("the second frame renders every tile") {
+                REQUIRE(pool.finished(second));
+                REQUIRE(rendered == tiles.size());
+            }
+        }
+    }
+}
+
+SCENARIO("A render pool renders passes in order") {
+    GIVEN("pool: render_pool(4)") {
+        RenderPool pool(4);
+        std::vector<Tile> tiles = TileScheduler::tile(0, 0, 64, 64, 8);
+
+        WHEN("frame: pool.submit([tiles, tiles, tiles], record)") {
+            std::atomic<size_t> rendered[3] = { { 0 }, { 0 }, { 0 } };
+            std::atomic<bool> outOfOrder { false };
+            uint64_t frame = pool.submit({ tiles, tiles, tiles }, [&](const Tile&, uint64_t, size_t pass) {
+                if (pass > 0 && rendered[pass - 1] != tiles.size()) outOfOrder = true;
+                rendered[pass]++;
+            });
+            pool.wait(frame);
+
+            THEN("every pass rendered every tile") {
+                REQUIRE(pool.passesFinished() == 3);
+                for (std::atomic<size_t>& count : rendered)
+                    REQUIRE(count == tiles.size());
+            }
+
+            AND_THEN("no pass started before the one before it finished") {
+                REQUIRE_FALSE(outOfOrder);
+            }
+        }
+    }
+}
@@ -0,0 +1,23 @@
+/***************
+ * THECURLE    *
+ *     BOUNCER *
+ ***************/
+
+#include <catch2/catch_test_macros.hpp>
+#include <string>
+#include <core/Json.h>
+
+SCENARIO("Writing strings as JSON", "[Json]") {
+    THEN("a plain string is only quoted") {
+        REQUIRE(jsonString("scene.txt") == "\"scene.txt\"");
+    }
+
+    AND_THEN("quotes and backslashes are escaped") {
+        REQUIRE(jsonString("C:\\say \"hi\"") == "\"C:\\\\say \\\"hi\\\"\"");
+    }
+
+    AND_THEN("control characters are escaped") {
+        REQUIRE(jsonString("a\tb\nc\rd") == "\"a\\tb\\nc\\rd\"");
+        REQUIRE(jsonString(std::string("\x01\x1f", 2)) == "\"\\u0001\\u001f\"");
+    }
+}
@@ -710,4 +710,71 @@ SCENARIO("Multiplying a matrix by its' inverse") {
             }
         }
     }
-}
\ No newline at end of file
+}
+SCENARIO("Multiplying two Mat4 matches the general Matrix product") {
+    GIVEN("A: Mat4 and B: Mat4") {
+        Mat4 A { 3, -9, 7, 3,
+                 3, -8, 2, -9,
+                 -4, 4, 4, 1,
+                 -6, 5, -1, 1 };
+        Mat4 B { 8, 2, 2, 2,
+                 3, -1, 7, 0,
+                 7, 0, 5, 4,
+                 6, -2, 0, 5 };
+
+        THEN("A * B = Matrix(A) * Matrix(B)") {
+            REQUIRE(Matrix(A) * Matrix(B) == Matrix(A * B));
+        }
+
+        AND_THEN("A * B * inverse(B) = A") {
+            REQUIRE(A * B * Mat4::inverse(B) == A);
+        }
+
+        AND_THEN("inverse(A) = inverse(Matrix(A))") {
+            REQUIRE(Mat4::inverse(A) == Matrix::inverse(Matrix(A)));
+        }
+    }
+}
+
+SCENARIO("Mat4 transforms are usable at compile time") {
+    GIVEN("T: translation(1, 2, 3) * scaling(2, 2, 2), evaluated as a constant") {
+        constexpr Mat4 T = Mat4::translation(1, 2, 3) * Mat4::scaling(2, 2, 2);
+
+        THEN("T is trivially copyable") {
+            REQUIRE(std::is_trivially_copyable_v<Mat4>);
+        }
+
+        AND_THEN("T * point(1, 1, 1) = point(3, 4, 5)") {
+            REQUIRE(T * Point(1, 1, 1) == Point(3, 4, 5));
+        }
+
+        AND_THEN("identity * T = T") {
+            constexpr Mat4 I = Mat4::identity();
+            REQUIRE(I * T == T);
+        }
+    }
+}
+
+SCENARIO("The closed-form affine inverse agrees with the LU inverse") {
+    GIVEN("T: translation(10, 5, 7) * rotation_x(pi / 3) * shearing(1, 0, 0, 2, 0.5, 0) * scaling(2, 3, 4)") {
+        Mat4 T = Mat4::translation(10, 5, 7) * Mat4::rotation_x(M_PI / 3) * Mat4::shearing(1, 0, 0, 2, 0.5, 0) * Mat4::scaling(2, 3, 4);
+
+        THEN("T is affine") {
+            REQUIRE(T.isAffine());
+        }
+
+        AND_THEN("affine_inverse(T) = general_inverse(T)") {
+            REQUIRE(Mat4::affineInverse(T) == Mat4::generalInverse(T));
+        }
+
+        AND_THEN("T * affine_inverse(T) = identity_matrix") {
+            REQUIRE(T * Mat4::affineInverse(T) == Mat4::identity());
+        }
+
+        AND_THEN("normal_matrix(inverse(T)) = transpose(inverse(T)) without translation") {
+            Mat4 expected = Mat4::transpose(Mat4::inverse(T));
+            expected.at(3, 0) = expected.at(3, 1) = expected.at(3, 2) = 0;
+            REQUIRE(Mat4::normalMatrix(Mat4::inverse(T)) == expected);
+        }
+    }
+}
@@ -0,0 +1,86 @@
+/***************
+ * THECURLE    *
+ *     BOUNCER *
+ ***************/
+
+#include <catch2/catch_test_macros.hpp>
+#include <core/Trace.h>
+#include <sstream>
+#include <thread>
+
+namespace {
+    size_t occurrences(const std::string& text, const std::string& of) {
+        size_t count = 0;
+        for (size_t at = text.find(of); at != std::string::npos; at = text.find(of, at + 1))
+            count++;
+        return count;
+    }
+}
+
+SCENARIO("Tracing records spans of work") {
+    Trace::Recorder& recorder = Trace::Recorder::get();
+
+    GIVEN("tracing is on") {
+        recorder.start();
+
+        WHEN("a scope runs here, and another on a second thread") {
+            { Trace::Scope trace("here"); }
+            std::thread([] { Trace::Scope trace("there"); }).join();
+            recorder.stop();
+
+            std::stringstream out;
+            recorder.write(out);
+            std::string trace = out.str();
+
+            THEN("both are written as complete events") {
+                REQUIRE(occurrences(trace, "\"name\":\"here\",\"ph\":\"X\"") == 1);
+                REQUIRE(occurrences(trace, "\"name\":\"there\",\"ph\":\"X\"") == 1);
+                REQUIRE(trace.find("\"traceEvents\":[") != std::string::npos);
+                REQUIRE(trace.find("\"dropped\":0") != std::string::npos);
+            }
+        }
+
+        WHEN("a scope's name has a quote in it") {
+            { Trace::Scope trace("say \"hi\""); }
+            recorder.stop();
+
+            std::stringstream out;
+            recorder.write(out);
+
+            THEN("the name is escaped") {
+                REQUIRE(occurrences(out.str(), "\"name\":\"say \\\"hi\\\"\",\"ph\":\"X\"") == 1);
+            }
+        }
+
+        WHEN("a thread records more spans than its ring holds") {
+            for (size_t i = 0; i < Trace::Ring::capacity + 10; i++)
+                Trace::Scope trace("many");
+            recorder.stop();
+
+            std::stringstream out;
+            recorder.write(out);
+            std::string trace = out.str();
+
+            // The oldest slot of a full ring is where the thread's next span goes, so it's never written out.
+            THEN("the newest are kept, and the rest are counted as dropped") {
+                REQUIRE(occurrences(trace, "\"name\":\"many\"") == Trace::Ring::capacity - 1);
+                REQUIRE(trace.find("\"dropped\":11}") != std::string::npos);
+            }
+        }
+    }
+
+    GIVEN("tracing is off") {
+        recorder.start();
+        recorder.stop();
+
+        WHEN("a scope runs") {
+            { Trace::Scope trace("unseen"); }
+            std::stringstream out;
+            recorder.write(out);
+
+            THEN("nothing is recorded") {
+                REQUIRE(out.str().find("unseen") == std::string::npos);
+            }
+        }
+    }
+}
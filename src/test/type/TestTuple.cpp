@@ -373,4 +373,29 @@ SCENARIO("Multiplying a color by a color", "[Tuple]") {
             }
         }
     }
-}
\ No newline at end of file
+}
+
+SCENARIO("Tuples can be copied as plain memory", "[Tuple]") {
+    THEN("tuple, point, vector and color are trivially copyable") {
+        REQUIRE(std::is_trivially_copyable_v<Tuple>);
+        REQUIRE(std::is_trivially_copyable_v<Point>);
+        REQUIRE(std::is_trivially_copyable_v<Vector>);
+        REQUIRE(std::is_trivially_copyable_v<Color>);
+    }
+
+    AND_THEN("tuples are aligned for the SIMD backend") {
+        REQUIRE(alignof(Tuple) >= (size_t) Simd::alignment);
+    }
+}
+
+SCENARIO("Color products are clamped to 1", "[Tuple]") {
+    GIVEN("c1 <- color(1.5, 0.5, 2)") {
+        Color c1(1.5, 0.5, 2);
+        AND_GIVEN("c2 <- color(1, 1.5, 0.25)") {
+            Color c2(1, 1.5, 0.25);
+            THEN("c1 * c2 = color(1, 0.75, 0.5)") {
+                REQUIRE(((c1 * c2) == Color(1, 0.75, 0.5)));
+            }
+        }
+    }
+}
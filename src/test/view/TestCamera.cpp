@@ -137,7 +137,7 @@ SCENARIO("Rendering with a camera") {
                             c.setTransform(Camera::viewMatrix(from, to, up));
                             WHEN("image: render(c, w)") {
                                 Framebuffer image(11, 11);
-                                w.renderRT(c, image, 0, 0, 11, 11);
+                                w.renderRT(c, image, 0, 0, 11, 11, false);
 
                                 THEN("pixel_at(image, 5, 5) = color(0.38066, 0.47583, 0.2855)") {
                                     REQUIRE(image.at(5, 5) == Color(0.38066, 0.47583, 0.2855).pack());
@@ -0,0 +1,114 @@
+/***************
+ * THECURLE    *
+ *     BOUNCER *
+ ***************/
+
+#include <catch2/catch_test_macros.hpp>
+#include <view/DoubleBuffer.h>
+#include <thread>
+
+namespace {
+    void fill(Framebuffer& f, const Tile& tile, uint32_t value) {
+        for (int y = tile.fromY; y < tile.toY; y++)
+            for (int x = tile.fromX; x < tile.toX; x++)
+                f.set(x, y, value);
+    }
+
+    // Whether every pixel of the tile holds the same value.
+    bool whole(Framebuffer& f, const Tile& tile) {
+        for (int y = tile.fromY; y < tile.toY; y++)
+            for (int x = tile.fromX; x < tile.toX; x++)
+                if (f.at(x, y) != f.at(tile.fromX, tile.fromY)) return false;
+        return true;
+    }
+}
+
+SCENARIO("Tiles are shown once they're published") {
+    GIVEN("buffers: a double buffer of 20x12 in 8 pixel tiles, and t: its second tile") {
+        DoubleBuffer buffers(20, 12, 8);
+        Tile t { 8, 0, 16, 8 };
+
+        THEN("nothing is shown before anything is published") {
+            fill(buffers.back(), t, 0xFF0000FF);
+            REQUIRE(buffers.present() == 0);
+            REQUIRE(buffers.front().at(8, 0) == 0);
+        }
+
+        WHEN("t is written and published") {
+            buffers.beginTile(t);
+            fill(buffers.back(), t, 0xFF0000FF);
+            buffers.publishTile(t);
+
+            THEN("only t is copied to the front") {
+                REQUIRE(buffers.present() == 1);
+                REQUIRE(buffers.front().at(8, 0) == 0xFF0000FF);
+                REQUIRE(buffers.front().at(15, 7) == 0xFF0000FF);
+                REQUIRE(buffers.front().at(7, 0) == 0);
+            }
+
+            AND_THEN("it isn't copied again") {
+                buffers.present();
+                REQUIRE(buffers.present() == 0);
+            }
+        }
+
+        WHEN("t is being written again") {
+            buffers.beginTile(t);
+            fill(buffers.back(), t, 0xFF0000FF);
+            buffers.publishTile(t);
+            buffers.present();
+
+            buffers.beginTile(t);
+            fill(buffers.back(), t, 0xFF00FF00);
+
+            THEN("the front keeps the last published version") {
+                REQUIRE(buffers.present() == 0);
+                REQUIRE(buffers.front().at(8, 0) == 0xFF0000FF);
+            }
+        }
+
+        WHEN("everything is published at once") {
+            fill(buffers.back(), { 0, 0, 20, 12 }, 0xFFFFFFFF);
+            buffers.publishAll();
+
+            THEN("every tile is copied, including those cut off by the edges") {
+                REQUIRE(buffers.present() == 6);
+                REQUIRE(buffers.front().at(19, 11) == 0xFFFFFFFF);
+            }
+        }
+    }
+}
+
+SCENARIO("The front buffer never shows a torn tile") {
+    GIVEN("buffers: a double buffer of 16x16 in 8 pixel tiles") {
+        DoubleBuffer buffers(16, 16, 8);
+        std::vector<Tile> tiles = TileScheduler::tile(0, 0, 16, 16, 8);
+
+        WHEN("one thread rewrites every tile over and over while the display presents") {
+            std::thread writer([&] {
+                for (uint32_t round = 1; round <= 2000; round++) {
+                    for (const Tile& t : tiles) {
+                        buffers.beginTile(t);
+                        fill(buffers.back(), t, round);
+                        buffers.publishTile(t);
+                    }
+                }
+            });
+
+            bool torn = false;
+            for (int i = 0; i < 2000 && !torn; i++) {
+                buffers.present();
+                for (const Tile& t : tiles)
+                    torn |= !whole(buffers.front(), t);
+            }
+            writer.join();
+
+            THEN("every tile shown was written in one go, and the last round is shown in the end") {
+                REQUIRE_FALSE(torn);
+                buffers.present();
+                for (const Tile& t : tiles)
+                    REQUIRE(buffers.front().at(t.fromX, t.fromY) == 2000);
+            }
+        }
+    }
+}
@@ -0,0 +1,79 @@
+/***************
+ * THECURLE    *
+ *     BOUNCER *
+ ***************/
+
+#include <catch2/catch_test_macros.hpp>
+#include <view/World.h>
+#include <view/Heatmap.h>
+
+SCENARIO("A heatmap records how long pixels took") {
+    GIVEN("costs: a 4x4 heatmap") {
+        Heatmap costs(4, 4);
+
+        THEN("every pixel starts at nothing") {
+            REQUIRE(costs.highest() == 0);
+        }
+
+        WHEN("a pixel that took a while is recorded over a 2x2 block") {
+            auto started = Heatmap::Clock::now() - std::chrono::microseconds(50);
+            costs.record(2, 2, 4, 4, started);
+
+            THEN("the whole block is put down to it, and nothing else") {
+                REQUIRE(costs.at(2, 2) >= 50000);
+                REQUIRE(costs.at(3, 3) == costs.at(2, 2));
+                REQUIRE(costs.at(1, 1) == 0);
+                REQUIRE(costs.highest() == costs.at(2, 2));
+            }
+
+            AND_WHEN("a cheaper block is recorded, and the map is painted") {
+                costs.record(0, 0, 2, 2, Heatmap::Clock::now() - std::chrono::microseconds(10));
+                Framebuffer image(4, 4);
+                costs.paint(image);
+
+                THEN("the most expensive pixels are white, and the cheapest and untimed ones black") {
+                    REQUIRE(image.at(3, 3) == Color(1, 1, 1).pack());
+                    REQUIRE(image.at(0, 0) == Color(0, 0, 0).pack());
+                    REQUIRE(image.at(0, 3) == Color(0, 0, 0).pack());
+                }
+            }
+        }
+
+        WHEN("a block hangs off the edge") {
+            costs.record(3, 3, 8, 8, Heatmap::Clock::now() - std::chrono::microseconds(10));
+
+            THEN("it's clipped to the map") {
+                REQUIRE(costs.at(3, 3) >= 10000);
+                REQUIRE(costs.at(2, 2) == 0);
+            }
+        }
+    }
+}
+
+SCENARIO("Rendering with a heatmap times every pixel, and renders the same image") {
+    GIVEN("w: default_world(), and a camera over it") {
+        World w = World::defaultWorld();
+        Camera c(11, 11, M_PI / 2);
+        c.setTransform({ 0, 0, -5 }, { 0, 0, 0 }, { 0, 1, 0 });
+        Tile all { 0, 0, 11, 11 };
+
+        WHEN("it is rendered with and without a heatmap") {
+            Framebuffer plain(11, 11), timed(11, 11);
+            Heatmap costs(11, 11);
+            w.renderTile(c, plain, all, false);
+            w.renderTile(c, timed, all, false, 1, true, nullptr, nullptr, &costs);
+
+            THEN("the images are the same") {
+                for (size_t y = 0; y < 11; y++)
+                    for (size_t x = 0; x < 11; x++)
+                        REQUIRE(timed.at(x, y) == plain.at(x, y));
+            }
+
+            AND_THEN("every pixel was timed") {
+                for (int y = 0; y < 11; y++)
+                    for (int x = 0; x < 11; x++)
+                        REQUIRE(costs.at(x, y) > 0);
+            }
+        }
+    }
+}
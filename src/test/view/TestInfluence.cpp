@@ -0,0 +1,138 @@
+/***************
+ * THECURLE    *
+ *     BOUNCER *
+ ***************/
+
+#include <catch2/catch_test_macros.hpp>
+#include <view/InfluenceMap.h>
+#include <view/World.h>
+
+using namespace RT;
+
+namespace {
+    // Trace every dirty tile again, recording as we go; what the live view does for each frame.
+    size_t renderDirty(World& w, const Camera& c, Framebuffer& image, InfluenceMap& influence) {
+        std::vector<Tile> tiles = influence.dirty();
+        for (const Tile& tile : tiles) {
+            TileInfluence& record = influence.at(tile);
+            record.clear();
+            w.renderTile(c, image, tile, false, 1, true, &record);
+            record.valid = true;
+        }
+        return tiles.size();
+    }
+
+    bool sameImage(Framebuffer& a, Framebuffer& b) {
+        for (size_t y = 0; y < a.height; y++)
+            for (size_t x = 0; x < a.width; x++)
+                if (a.at(x, y) != b.at(x, y)) return false;
+        return true;
+    }
+}
+
+SCENARIO("Edits only trace again the tiles they could change") {
+    GIVEN("w: a world of two small spheres, one in front of the other, in empty space") {
+        auto* near = new Sphere;
+        near->setMatrix(Matrix::translation(-2, 0, 0) * Matrix::scaling(0.5, 0.5, 0.5));
+        auto* far = new Sphere;
+        far->setMatrix(Matrix::translation(2, 0, 0) * Matrix::scaling(0.5, 0.5, 0.5));
+        World w({ near, far }, PointLight({ 0, 10, -10 }, { 1, 1, 1 }));
+
+        AND_GIVEN("c: camera(64, 48, π/3) looking at the origin from (0, 0, -8), and an influence map in 8 pixel tiles") {
+            Camera c(64, 48, M_PI / 3);
+            c.setTransform({ 0, 0, -8 }, { 0, 0, 0 }, { 0, 1, 0 });
+            InfluenceMap influence(64, 48, 8);
+            Framebuffer image(64, 48);
+
+            THEN("the first frame traces every tile") {
+                REQUIRE(renderDirty(w, c, image, influence) == 48);
+                REQUIRE(influence.dirty().empty());
+            }
+
+            WHEN("the color of the near sphere changes") {
+                renderDirty(w, c, image, influence);
+                near->material.color = Color(0, 0, 1);
+                influence.objectChanged(near);
+
+                THEN("only the tiles it covers are traced, and the image matches a full render") {
+                    size_t traced = renderDirty(w, c, image, influence);
+                    REQUIRE(traced > 0);
+                    REQUIRE(traced < 48);
+
+                    Framebuffer full(64, 48);
+                    w.renderTile(c, full, { 0, 0, 64, 48 }, false);
+                    REQUIRE(sameImage(image, full));
+                }
+            }
+
+            WHEN("the near sphere moves up") {
+                renderDirty(w, c, image, influence);
+                Bounds before = near->worldBounds();
+                near->setMatrix(Matrix::translation(-2, 1, 0) * Matrix::scaling(0.5, 0.5, 0.5));
+                w.buildAccel();
+                influence.objectMoved(near, before, near->worldBounds(), c, w.lightSource);
+
+                THEN("the tiles of the far sphere are left alone, and the image matches a full render") {
+                    size_t traced = renderDirty(w, c, image, influence);
+                    REQUIRE(traced > 0);
+                    REQUIRE(traced < 48);
+
+                    Framebuffer full(64, 48);
+                    w.renderTile(c, full, { 0, 0, 64, 48 }, false);
+                    REQUIRE(sameImage(image, full));
+                }
+            }
+
+            WHEN("the light changes color") {
+                renderDirty(w, c, image, influence);
+                w.lightSource.intensity = Color(1, 0.5, 0.5);
+                influence.lightChanged();
+
+                THEN("the empty tiles are left alone, and the image matches a full render") {
+                    size_t traced = renderDirty(w, c, image, influence);
+                    REQUIRE(traced > 0);
+                    REQUIRE(traced < 48);
+
+                    Framebuffer full(64, 48);
+                    w.renderTile(c, full, { 0, 0, 64, 48 }, false);
+                    REQUIRE(sameImage(image, full));
+                }
+            }
+        }
+    }
+}
+
+SCENARIO("Projecting bounds onto the screen") {
+    GIVEN("c: camera(64, 48, π/3) looking at the origin from (0, 0, -8)") {
+        Camera c(64, 48, M_PI / 3);
+        c.setTransform({ 0, 0, -8 }, { 0, 0, 0 }, { 0, 1, 0 });
+        InfluenceMap influence(64, 48, 8);
+
+        THEN("the origin projects to the middle of the screen") {
+            Scalar x, y;
+            REQUIRE(c.project(Point(0, 0, 0), x, y));
+            REQUIRE(safeCompare(x, 31.5));
+            REQUIRE(safeCompare(y, 23.5));
+        }
+
+        AND_THEN("a point behind the camera doesn't project") {
+            Scalar x, y;
+            REQUIRE_FALSE(c.project(Point(0, 0, -10), x, y));
+        }
+
+        AND_THEN("projection is the inverse of casting a ray") {
+            Ray r = c.rayForPixel(10, 40);
+            Scalar x, y;
+            REQUIRE(c.project(Ray::position(r, 5), x, y));
+            REQUIRE(safeCompare(x, 10));
+            REQUIRE(safeCompare(y, 40));
+        }
+
+        AND_THEN("bounds that reach behind the camera cover the whole screen") {
+            Bounds b;
+            b.extend(0, 0, -10);
+            b.extend(1, 1, 0);
+            REQUIRE(influence.onScreen(b, c) == Tile { 0, 0, 64, 48 });
+        }
+    }
+}
@@ -0,0 +1,125 @@
+/***************
+ * THECURLE    *
+ *     BOUNCER *
+ ***************/
+
+#include <catch2/catch_test_macros.hpp>
+#include <view/Reprojection.h>
+#include <view/World.h>
+
+using namespace RT;
+
+namespace {
+    // The biggest difference in any channel between two packed colors.
+    int channelDifference(uint32_t a, uint32_t b) {
+        int most = 0;
+        for (int shift = 0; shift < 24; shift += 8)
+            most = std::max(most, std::abs((int) ((a >> shift) & 0xFF) - (int) ((b >> shift) & 0xFF)));
+        return most;
+    }
+}
+
+SCENARIO("Reprojecting a frame to the camera that rendered it") {
+    GIVEN("w: a matte sphere lit from the front, rendered by camera(32, 32, π/3) with history") {
+        auto* s = new Sphere;
+        s->material.specular = 0;
+        World w({ s }, PointLight({ -10, 10, -10 }, { 1, 1, 1 }));
+        Camera c(32, 32, M_PI / 3);
+        c.setTransform({ 0, 0, -5 }, { 0, 0, 0 }, { 0, 1, 0 });
+
+        Tile all { 0, 0, 32, 32 };
+        Framebuffer image(32, 32);
+        Reprojection history(32, 32);
+        history.traceAll(all);
+        w.renderTile(c, image, all, false, 1, true, nullptr, &history);
+
+        WHEN("history.reproject(c, image)") {
+            Framebuffer before(32, 32);
+            for (int y = 0; y < 32; y++)
+                for (int x = 0; x < 32; x++)
+                    before.set(x, y, image.at(x, y));
+            history.reproject(c, image);
+
+            THEN("the sphere is reused and only the empty space around it is traced") {
+                REQUIRE_FALSE(history.needsTrace(16, 16));
+                REQUIRE(history.needsTrace(0, 0));
+            }
+
+            AND_THEN("the image is unchanged") {
+                for (int y = 0; y < 32; y++)
+                    for (int x = 0; x < 32; x++)
+                        REQUIRE(image.at(x, y) == before.at(x, y));
+            }
+        }
+    }
+}
+
+SCENARIO("Reprojecting a frame to an orbited camera") {
+    GIVEN("w: a matte sphere on a matte floor, rendered by camera(64, 48, π/3) looking down at it with history") {
+        auto* s = new Sphere;
+        s->material.specular = 0;
+        auto* floor = new Plane;
+        floor->setMatrix(Matrix::translation(0, -1, 0));
+        floor->material.specular = 0;
+        World w({ s, floor }, PointLight({ -10, 10, -10 }, { 1, 1, 1 }));
+        Camera c(64, 48, M_PI / 3);
+        c.setTransform({ 0, 6, -3 }, { 0, 0, 0 }, { 0, 1, 0 });
+
+        Tile all { 0, 0, 64, 48 };
+        Framebuffer image(64, 48);
+        Reprojection history(64, 48);
+        history.traceAll(all);
+        w.renderTile(c, image, all, false, 1, true, nullptr, &history);
+
+        WHEN("the camera orbits a little, and only what reprojection leaves uncovered is traced") {
+            Camera moved = c;
+            moved.setTransform(c.transform * Matrix::rotation_y(0.05));
+            history.reproject(moved, image);
+
+            size_t traced = 0;
+            for (int y = 0; y < 48; y++)
+                for (int x = 0; x < 64; x++)
+                    traced += history.needsTrace(x, y);
+            w.renderTile(moved, image, all, false, 1, true, nullptr, &history);
+
+            THEN("most pixels are reused") {
+                REQUIRE(traced < 64 * 48 / 10);
+            }
+
+            AND_THEN("nearly every pixel is within a few levels of a full render") {
+                Framebuffer full(64, 48);
+                w.renderTile(moved, full, all, false);
+
+                size_t close = 0;
+                for (int y = 0; y < 48; y++)
+                    for (int x = 0; x < 64; x++)
+                        close += channelDifference(image.at(x, y), full.at(x, y)) <= 4;
+                REQUIRE(close >= 64 * 48 * 98 / 100);
+            }
+        }
+    }
+}
+
+SCENARIO("Reflective and transparent hits aren't reprojected") {
+    GIVEN("w: a mirrored sphere, rendered by camera(32, 32, π/3) with history") {
+        auto* s = new Sphere;
+        s->material.reflectivity = 0.5;
+        World w({ s }, PointLight({ -10, 10, -10 }, { 1, 1, 1 }));
+        Camera c(32, 32, M_PI / 3);
+        c.setTransform({ 0, 0, -5 }, { 0, 0, 0 }, { 0, 1, 0 });
+
+        Tile all { 0, 0, 32, 32 };
+        Framebuffer image(32, 32);
+        Reprojection history(32, 32);
+        history.traceAll(all);
+        w.renderTile(c, image, all, false, 1, true, nullptr, &history);
+
+        WHEN("history.reproject(c, image)") {
+            history.reproject(c, image);
+
+            THEN("the sphere is traced again") {
+                REQUIRE(history.needsTrace(16, 16));
+            }
+        }
+    }
+}
@@ -0,0 +1,297 @@
+/***************
+ * THECURLE    *
+ *     BOUNCER *
+ ***************/
+
+#include <catch2/catch_test_macros.hpp>
+#include <view/Scene.h>
+#include <algorithm>
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <sstream>
+
+using namespace RT;
+
+namespace {
+    bool load(const std::string& text, Scene& scene, std::string& error) {
+        std::istringstream in(text);
+        return Scene::load(in, scene, error);
+    }
+
+    // A scene file in the temporary directory under a name nothing else is using, removed along with its cache when
+    // this goes; so that test runs side by side don't trip over each other's files.
+    struct TempScene {
+        std::filesystem::path path;
+
+        TempScene() {
+            std::random_device random;
+            do {
+                path = std::filesystem::temp_directory_path() / ("bouncer-test-" + std::to_string(random()) + ".scene");
+            } while (std::filesystem::exists(path));
+        }
+
+        ~TempScene() {
+            std::error_code ignored;
+            std::filesystem::remove(path, ignored);
+            std::filesystem::remove(Scene::cachePath(path.string()), ignored);
+        }
+
+        TempScene(const TempScene&) = delete;
+        TempScene& operator=(const TempScene&) = delete;
+    };
+}
+
+SCENARIO("Loading a scene from text") {
+    GIVEN("text: a camera, a light, a patterned floor material, a plane and a sphere") {
+        std::string text =
+                "# A test scene\n"
+                "camera from 0 1.5 -5 to 0 1 0 up 0 1 0 fov 90\n"
+                "light position -10 10 -10 intensity 0.5 0.5 0.5\n"
+                "\n"
+                "pattern tiles checker a 1 0 0 b 0 0 1 scale 2 2 2\n"
+                "material floor pattern tiles specular 0 reflectivity 0.25\n"
+                "plane material floor translate 0 -1 0   # the ground\n"
+                "sphere material floor color 0 1 0 scale 0.5 0.5 0.5 translate 1 0 0";
+
+        WHEN("scene: the text is loaded") {
+            Scene scene;
+            std::string error;
+            SceneLoadStats stats;
+            std::istringstream in(text);
+            bool loaded = Scene::load(in, scene, error, &stats);
+
+            THEN("it loads, with both objects in the order written") {
+                REQUIRE(loaded);
+                REQUIRE(stats.objects == 2);
+                REQUIRE(scene.world.numObjs == 2);
+                REQUIRE(std::string(scene.world.objects[0]->getName()) == "Plane");
+                REQUIRE(std::string(scene.world.objects[1]->getName()) == "Sphere");
+            }
+
+            AND_THEN("the camera and light are as written, with angles in degrees") {
+                REQUIRE(scene.from == Point(0, 1.5, -5));
+                REQUIRE(scene.to == Point(0, 1, 0));
+                REQUIRE(safeCompare(scene.fieldOfView, M_PI / 2));
+                REQUIRE(scene.world.lightSource == PointLight({ -10, 10, -10 }, { 0.5, 0.5, 0.5 }));
+            }
+
+            AND_THEN("objects take the named material, and then their own settings") {
+                Geo* floor = scene.world.objects[0];
+                Geo* ball = scene.world.objects[1];
+                REQUIRE(floor->material.specular == 0);
+                REQUIRE(floor->material.reflectivity == 0.25);
+                REQUIRE(floor->material.pattern != nullptr);
+                REQUIRE(floor->material.pattern->a == Color(1, 0, 0));
+                REQUIRE(floor->material.pattern->transform == Mat4::scaling(2, 2, 2));
+                REQUIRE(ball->material.reflectivity == 0.25);
+                REQUIRE(ball->material.color == Color(0, 1, 0));
+            }
+
+            AND_THEN("transforms are applied in the order written") {
+                REQUIRE(scene.world.objects[0]->transform == Mat4::translation(0, -1, 0));
+                REQUIRE(scene.world.objects[1]->transform == Mat4::translation(1, 0, 0) * Mat4::scaling(0.5, 0.5, 0.5));
+            }
+
+            AND_THEN("the world can be rendered") {
+                Ray r(Point(1, 0, -5), Vector(0, 0, 1));
+                REQUIRE(scene.world.closestHit(r).object == scene.world.objects[1]);
+            }
+        }
+    }
+}
+
+SCENARIO("A scene file that matches a built-in scene renders the same") {
+    GIVEN("text: the four spheres of the live view") {
+        std::string text =
+                "camera from 0 0 -1500 to 0 0 0\n"
+                "light position -50 100 -250 intensity 1 1 1\n"
+                "sphere scale 100 100 100 color 1 0 0\n"
+                "sphere scale 100 100 100 translate 100 0 200\n"
+                "sphere scale 100 100 100 translate -100 0 -200\n"
+                "sphere scale 100 100 100 translate 200 200 200\n";
+
+        WHEN("it is loaded and rendered next to the built-in") {
+            Scene loaded, builtin = Scene::spheres();
+            std::string error;
+            REQUIRE(load(text, loaded, error));
+
+            Framebuffer a(64, 48), b(64, 48);
+            loaded.world.renderTile(loaded.camera(64, 48), a, { 0, 0, 64, 48 }, false);
+            builtin.world.renderTile(builtin.camera(64, 48), b, { 0, 0, 64, 48 }, false);
+
+            THEN("the images are the same") {
+                for (int y = 0; y < 48; y++)
+                    for (int x = 0; x < 64; x++)
+                        REQUIRE(a.at(x, y) == b.at(x, y));
+            }
+        }
+    }
+}
+
+SCENARIO("Mistakes in a scene are reported by line") {
+    Scene scene;
+    std::string error;
+
+    THEN("an unknown statement is reported") {
+        REQUIRE_FALSE(load("sphere\ncube\n", scene, error));
+        REQUIRE(error == "line 2: unknown statement 'cube'");
+    }
+
+    AND_THEN("a missing number is reported") {
+        REQUIRE_FALSE(load("sphere translate 1 2", scene, error));
+        REQUIRE(error == "line 1: expected a number");
+    }
+
+    AND_THEN("a malformed number is reported") {
+        REQUIRE_FALSE(load("sphere scale 1 2 x3", scene, error));
+        REQUIRE(error == "line 1: expected a number, not 'x3'");
+    }
+
+    AND_THEN("a material that doesn't exist is reported") {
+        REQUIRE_FALSE(load("plane material glass", scene, error));
+        REQUIRE(error == "line 1: no material called 'glass'");
+    }
+}
+
+SCENARIO("Scenes load through their binary cache") {
+    GIVEN("path: a scene file with a patterned plane, a glass sphere and a matte sphere") {
+        TempScene file;
+        const std::filesystem::path& path = file.path;
+        {
+            std::ofstream out(path);
+            out << "camera from 0 2 -6 to 0 0 0\n"
+                   "light position -10 10 -10 intensity 1 1 1\n"
+                   "pattern tiles checker a 1 1 1 b 0.2 0.2 0.2 rotate-y 30\n"
+                   "plane pattern tiles translate 0 -1 0 reflectivity 0.3\n"
+                   "sphere transparency 0.9 refractiveIndex 1.5 diffuse 0.1\n"
+                   "sphere color 0.2 0.4 1 scale 0.5 0.5 0.5 translate 1.5 0 1\n";
+        }
+
+        WHEN("it is loaded twice") {
+            Scene first, second;
+            std::string error;
+            SceneLoadStats firstStats, secondStats;
+            REQUIRE(Scene::loadFileCached(path.string(), first, error, &firstStats));
+            REQUIRE(Scene::loadFileCached(path.string(), second, error, &secondStats));
+
+            THEN("the first load parses the text, and the second comes from the cache") {
+                REQUIRE_FALSE(firstStats.cached);
+                REQUIRE(secondStats.cached);
+                REQUIRE(secondStats.objects == 3);
+            }
+
+            AND_THEN("both render the same image") {
+                Framebuffer a(48, 32), b(48, 32);
+                first.world.renderTile(first.camera(48, 32), a, { 0, 0, 48, 32 }, false);
+                second.world.renderTile(second.camera(48, 32), b, { 0, 0, 48, 32 }, false);
+                for (int y = 0; y < 32; y++)
+                    for (int x = 0; x < 48; x++)
+                        REQUIRE(a.at(x, y) == b.at(x, y));
+            }
+        }
+
+        WHEN("the scene file changes after the cache was written") {
+            Scene scene;
+            std::string error;
+            REQUIRE(Scene::loadFileCached(path.string(), scene, error));
+            {
+                std::ofstream out(path, std::ios::app);
+                out << "sphere translate 0 3 0\n";
+            }
+
+            THEN("the cache is stale, and the text is loaded again") {
+                Scene cached;
+                REQUIRE_FALSE(Scene::loadCache(Scene::cachePath(path.string()), path.string(), cached, error));
+
+                SceneLoadStats stats;
+                REQUIRE(Scene::loadFileCached(path.string(), scene, error, &stats));
+                REQUIRE_FALSE(stats.cached);
+                REQUIRE(scene.world.numObjs == 4);
+            }
+        }
+
+        WHEN("the cache is cut short") {
+            Scene scene;
+            std::string error;
+            REQUIRE(Scene::loadFileCached(path.string(), scene, error));
+            std::string cache = Scene::cachePath(path.string());
+            std::filesystem::resize_file(cache, std::filesystem::file_size(cache) - 4);
+
+            THEN("it is refused, and the text is loaded instead") {
+                REQUIRE_FALSE(Scene::loadCache(cache, path.string(), scene, error));
+                REQUIRE(error == cache + " is damaged");
+
+                SceneLoadStats stats;
+                REQUIRE(Scene::loadFileCached(path.string(), scene, error, &stats));
+                REQUIRE_FALSE(stats.cached);
+                REQUIRE(scene.world.numObjs == 3);
+            }
+        }
+
+        WHEN("a node of the cached tree is made to point back at itself") {
+            // A row of spheres, for a tree with more than one node.
+            {
+                std::ofstream out(path, std::ios::app);
+                for (int i = 0; i < 16; i++)
+                    out << "sphere translate " << i * 3 << " 0 10\n";
+            }
+            Scene scene;
+            std::string error;
+            REQUIRE(Scene::loadFileCached(path.string(), scene, error));
+            const BVH& accel = scene.world.accel;
+            REQUIRE(accel.nodes.size() > 1);
+            REQUIRE(accel.nodes[0].count == 0);
+
+            // The nodes are followed by the indices of the tree's objects and of the unbounded ones, at the end of the file.
+            std::string cache = Scene::cachePath(path.string());
+            auto root = (std::streamoff) (std::filesystem::file_size(cache) - (accel.prims.size() + accel.unbounded.size()) * sizeof(uint32_t) -
+                                          accel.nodes.size() * sizeof(BVH::Node));
+            {
+                std::fstream damage(cache, std::ios::in | std::ios::out | std::ios::binary);
+                damage.seekp(root + (std::streamoff) offsetof(BVH::Node, offset));
+                uint32_t self = 0;
+                damage.write((const char*) &self, sizeof(self));
+            }
+
+            THEN("it is refused") {
+                REQUIRE_FALSE(Scene::loadCache(cache, path.string(), scene, error));
+                REQUIRE(error == cache + " is damaged");
+            }
+        }
+    }
+}
+
+SCENARIO("The benchmark corpus is built in") {
+    GIVEN("names: every scene in the corpus") {
+        std::vector<std::string> names = Scene::corpus();
+
+        THEN("each is also a built-in scene") {
+            std::vector<std::string> builtins = Scene::builtins();
+            for (const std::string& name : names)
+                REQUIRE(std::find(builtins.begin(), builtins.end(), name) != builtins.end());
+        }
+
+        AND_THEN("the sweeps have as many objects as they're named for") {
+            Scene scene;
+            REQUIRE(Scene::builtin("sweep-1000", scene));
+            REQUIRE(scene.world.numObjs == 1000);
+        }
+    }
+
+    WHEN("a corpus scene is built twice") {
+        Scene first, second;
+        REQUIRE(Scene::builtin("diffuse-spheres", first));
+        REQUIRE(Scene::builtin("diffuse-spheres", second));
+
+        THEN("both render the same image") {
+            Framebuffer a(48, 32), b(48, 32);
+            first.world.renderTile(first.camera(48, 32), a, { 0, 0, 48, 32 }, false);
+            second.world.renderTile(second.camera(48, 32), b, { 0, 0, 48, 32 }, false);
+            for (int y = 0; y < 32; y++)
+                for (int x = 0; x < 48; x++)
+                    REQUIRE(a.at(x, y) == b.at(x, y));
+        }
+    }
+}
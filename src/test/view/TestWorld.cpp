@@ -93,6 +93,29 @@ SCENARIO("Intersecting a world with a ray") {
     }
 }
 
+SCENARIO("Occlusion only looks as far as t-max") {
+    GIVEN("w: default_world()") {
+        World w = World::defaultWorld();
+        AND_GIVEN("r: ray( point(0, 0, -5), vector(0, 0, 1) )") {
+            Ray r { {0, 0, -5 }, { 0, 0, 1 } };
+            THEN("occluded(w, r, 5) = true") {
+                REQUIRE(w.occluded(r, 5));
+            }
+
+            AND_THEN("occluded(w, r, 4) = false") {
+                REQUIRE(w.occluded(r, 4) == false);
+            }
+        }
+
+        AND_GIVEN("r: ray( point(0, 0, -5), vector(0, 0, -1) )") {
+            Ray r { {0, 0, -5 }, { 0, 0, -1 } };
+            THEN("occluded(w, r, 100) = false") {
+                REQUIRE(w.occluded(r, 100) == false);
+            }
+        }
+    }
+}
+
 SCENARIO("Color of a missed ray") {
     GIVEN("w: default_world()") {
         World w = World::defaultWorld();
@@ -180,4 +203,72 @@ SCENARIO("View transformation moves the world") {
             }
         }
     }
-}
\ No newline at end of file
+}
+SCENARIO("Rendering coarse to fine gives the same image") {
+    GIVEN("w: default_world()") {
+        World w = World::defaultWorld();
+        AND_GIVEN("c: camera(11, 11, π/2) looking at the origin from (0, 0, -5)") {
+            Camera c(11, 11, M_PI / 2);
+            c.setTransform({ 0, 0, -5 }, { 0, 0, 0 }, { 0, 1, 0 });
+            Tile all { 0, 0, 11, 11 };
+
+            Framebuffer full(11, 11);
+            w.renderTile(c, full, all, false);
+
+            WHEN("image: render_tile(c, w, step: 4)") {
+                Framebuffer image(11, 11);
+                w.renderTile(c, image, all, false, 4, true);
+
+                THEN("each traced pixel is splatted over its block") {
+                    REQUIRE(image.at(4, 4) == full.at(4, 4));
+                    REQUIRE(image.at(7, 7) == full.at(4, 4));
+                    REQUIRE(image.at(10, 10) == full.at(8, 8));
+                }
+
+                AND_WHEN("the levels at steps 2 and 1 are rendered") {
+                    w.renderTile(c, image, all, false, 2, false);
+                    w.renderTile(c, image, all, false, 1, false);
+
+                    THEN("image = the full render") {
+                        for (size_t y = 0; y < 11; y++)
+                            for (size_t x = 0; x < 11; x++)
+                                REQUIRE(image.at(x, y) == full.at(x, y));
+                    }
+                }
+            }
+        }
+    }
+}
+
+SCENARIO("Rendering counts the work it does") {
+    GIVEN("w: default_world(), with the outer sphere made reflective") {
+        World w = World::defaultWorld();
+        w.objects[0]->material.reflectivity = 0.5;
+        Camera c(11, 11, M_PI / 2);
+        c.setTransform({ 0, 0, -5 }, { 0, 0, 0 }, { 0, 1, 0 });
+
+        WHEN("stats: render(c, w)") {
+            Framebuffer image(11, 11);
+            std::ostream quiet(nullptr);
+            RenderStats stats = w.renderRT(c, image, 0, 0, 11, 11, false, quiet);
+
+            THEN("one camera ray is counted per pixel, at depth 0") {
+                REQUIRE(stats[RenderStats::PrimaryRays] == 121);
+                REQUIRE(stats.depths[0] == 121);
+            }
+
+            AND_THEN("every shaded hit cast a shadow ray, and the reflections are counted a level down") {
+                REQUIRE(stats[RenderStats::ShadowRays] == stats[RenderStats::DetailFills]);
+                REQUIRE(stats[RenderStats::ReflectionRays] > 0);
+                REQUIRE(stats.depths[1] == stats[RenderStats::ReflectionRays]);
+                REQUIRE(stats[RenderStats::RefractionRays] == 0);
+            }
+
+            AND_THEN("the spheres were tested, and nothing is counted after the render") {
+                REQUIRE(stats[RenderStats::SphereTests] > 0);
+                REQUIRE(stats[RenderStats::PlaneTests] == 0);
+                REQUIRE(RenderStats::recording() == nullptr);
+            }
+        }
+    }
+}